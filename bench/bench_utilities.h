@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2021 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system, or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#ifndef _PIM_BENCH_UTILITIES_H_
+#define _PIM_BENCH_UTILITIES_H_
+
+#include "half.hpp"
+#include "pim_mock_api.h"
+#include "pim_runtime_api.h"
+#include <algorithm>
+#include <benchmark/benchmark.h>
+#include <stdint.h>
+#include <thread>
+#include <vector>
+
+using namespace pim::mock;
+
+// Initializes PIM with 'num_threads' threads, 0 for the default, for the
+// duration of a benchmark run.
+class PimSession {
+public:
+  explicit PimSession(int64_t num_threads) {
+    PimSetNumThreads(static_cast<uint32_t>(num_threads));
+    PimInitialize(RT_TYPE_HIP, PIM_FP16);
+  }
+  ~PimSession() {
+    PimDeinitialize();
+    PimSetNumThreads(0);
+  }
+};
+
+// Thread counts to benchmark: a single thread and all hardware threads.
+inline std::vector<int64_t> thread_counts() {
+  int64_t all = std::max(std::thread::hardware_concurrency(), 1u);
+  return all > 1 ? std::vector<int64_t>{1, all} : std::vector<int64_t>{1};
+}
+
+inline PimPrecision precision_arg(int64_t int8) {
+  return int8 ? PIM_INT8 : PIM_FP16;
+}
+
+// Fills the buffer with 'value', including the row padding, so that the
+// kernels do not run on denormals or uninitialized memory.
+inline void fill(PimBo *bo, float value) {
+  if (bo->precision == PIM_INT8) {
+    int8_t *data = static_cast<int8_t *>(bo->data);
+    std::fill(data, data + bo->size, static_cast<int8_t>(value));
+    return;
+  }
+  half_float::half *data = static_cast<half_float::half *>(bo->data);
+  std::fill(data, data + bo->size / sizeof(half_float::half),
+            half_float::half(value));
+}
+
+// Reports the bytes read plus written and the arithmetic operations of one
+// iteration as rates in GB/s and GFLOP/s (operations on integers for INT8).
+inline void set_rates(benchmark::State &state, double bytes, double flops) {
+  state.counters["GB"] = benchmark::Counter(
+      bytes * 1e-9, benchmark::Counter::kIsIterationInvariantRate);
+  if (flops > 0) {
+    state.counters["GFLOP"] = benchmark::Counter(
+        flops * 1e-9, benchmark::Counter::kIsIterationInvariantRate);
+  }
+}
+
+#endif /* _PIM_BENCH_UTILITIES_H_ */
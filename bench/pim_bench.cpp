@@ -0,0 +1,29 @@
+/*
+ * Copyright (C) 2021 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system, or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#include "bench_utilities.h"
+#include <string>
+
+// Runs the benchmarks given on the command line, see --help. The context of
+// the results includes the kernels and the default number of threads.
+int main(int argc, char **argv) {
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv))
+    return 1;
+  PimInitialize(RT_TYPE_HIP, PIM_FP16);
+  benchmark::AddCustomContext("pimmock_isa", PimGetKernelIsa());
+  benchmark::AddCustomContext("pimmock_threads",
+                              std::to_string(PimGetNumThreads()));
+  PimDeinitialize();
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  return 0;
+}
@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2021 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system, or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#include "bench_utilities.h"
+
+// Benchmarks of the blocking copies, which are bound by the memory bandwidth.
+
+// Copies a buffer of 'bytes' bytes from the host to PIM memory.
+static void BM_Copy(benchmark::State &state) {
+  int length = static_cast<int>(state.range(0) / sizeof(half_float::half));
+  PimSession session(state.range(1));
+
+  PimBo *host = PimCreateBo(length, 1, 1, 1, PIM_FP16, MEM_TYPE_HOST);
+  PimBo *device = PimCreateBo(length, 1, 1, 1, PIM_FP16, MEM_TYPE_PIM);
+  fill(host, 1.0f);
+  for (auto _ : state) {
+    PimCopyMemory(device, host, HOST_TO_PIM);
+    benchmark::ClobberMemory();
+  }
+  set_rates(state, 2.0 * host->size, 0);
+  PimDestroyBo(host);
+  PimDestroyBo(device);
+}
+BENCHMARK(BM_Copy)
+    ->ArgNames({"bytes", "threads"})
+    ->Apply([](benchmark::internal::Benchmark *b) {
+      for (int64_t bytes : {64 << 10, 4 << 20, 64 << 20})
+        for (int64_t threads : thread_counts())
+          b->Args({bytes, threads});
+    })
+    ->UseRealTime();
+
+// Copies a box of 'depth' slices of 'height' rows of 'width' bytes from the
+// interior of a host buffer with twice the width and height into packed PIM
+// memory.
+static void BM_CopyRect(benchmark::State &state) {
+  size_t width = static_cast<size_t>(state.range(0));
+  size_t height = static_cast<size_t>(state.range(1));
+  size_t depth = static_cast<size_t>(state.range(2));
+  PimSession session(state.range(3));
+
+  std::vector<char> host(4 * width * height * depth, 1);
+  void *device = nullptr;
+  PimAllocMemory(&device, width * height * depth, MEM_TYPE_PIM);
+  PimCopy3D params = {};
+  params.src_x_in_bytes = width / 2;
+  params.src_y = height / 2;
+  params.src_mem_type = MEM_TYPE_HOST;
+  params.src_ptr = host.data();
+  params.src_pitch = 2 * width;
+  params.src_height = 2 * height;
+  params.dst_mem_type = MEM_TYPE_PIM;
+  params.dst_ptr = device;
+  params.dst_pitch = width;
+  params.dst_height = height;
+  params.width_in_bytes = width;
+  params.height = height;
+  params.depth = depth;
+  for (auto _ : state) {
+    PimCopyMemoryRect(&params);
+    benchmark::ClobberMemory();
+  }
+  set_rates(state, 2.0 * width * height * depth, 0);
+  PimFreeMemory(device, MEM_TYPE_PIM);
+}
+BENCHMARK(BM_CopyRect)
+    ->ArgNames({"width", "height", "depth", "threads"})
+    ->Apply([](benchmark::internal::Benchmark *b) {
+      const int64_t boxes[][3] = {{64, 4096, 16}, {1024, 1024, 4},
+                                  {16 << 10, 256, 4}};
+      for (const auto &box : boxes)
+        for (int64_t threads : thread_counts())
+          b->Args({box[0], box[1], box[2], threads});
+    })
+    ->UseRealTime();
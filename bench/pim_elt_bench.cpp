@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2021 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system, or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#include "bench_utilities.h"
+
+// Benchmarks of the element-wise operations and BN on (W, 1, 1, N) buffers,
+// which are bound by the memory bandwidth.
+
+enum EltOp { ELT_ADD, ELT_MUL, ELT_RELU };
+
+static void run_elementwise(benchmark::State &state, EltOp op) {
+  int w = static_cast<int>(state.range(0));
+  int n = static_cast<int>(state.range(1));
+  PimPrecision precision = precision_arg(state.range(2));
+  PimSession session(state.range(3));
+
+  PimBo *input0 = PimCreateBo(w, 1, 1, n, precision, MEM_TYPE_PIM);
+  PimBo *input1 = PimCreateBo(w, 1, 1, n, precision, MEM_TYPE_PIM);
+  PimBo *output = PimCreateBo(w, 1, 1, n, precision, MEM_TYPE_PIM);
+  fill(input0, 1.0f);
+  fill(input1, 2.0f);
+  for (auto _ : state) {
+    switch (op) {
+    case ELT_ADD:
+      PimExecuteAdd(output, input0, input1, nullptr, true);
+      break;
+    case ELT_MUL:
+      PimExecuteMul(output, input0, input1, nullptr, true);
+      break;
+    case ELT_RELU:
+      PimExecuteRelu(output, input0, nullptr, true);
+      break;
+    }
+    benchmark::ClobberMemory();
+  }
+  size_t num_inputs = (op == ELT_RELU) ? 1 : 2;
+  double elements = static_cast<double>(w) * n;
+  set_rates(state, static_cast<double>((num_inputs + 1) * output->size),
+            (op == ELT_RELU) ? 0 : elements);
+  for (PimBo *bo : {input0, input1, output})
+    PimDestroyBo(bo);
+}
+
+static void elementwise_args(benchmark::internal::Benchmark *b) {
+  b->ArgNames({"w", "n", "int8", "threads"});
+  for (int64_t w : {4 * 1024, 64 * 1024, 1024 * 1024})
+    for (int64_t n : {1, 8})
+      for (int64_t int8 : {0, 1})
+        for (int64_t threads : thread_counts())
+          b->Args({w, n, int8, threads});
+  b->UseRealTime();
+}
+
+static void BM_Add(benchmark::State &state) {
+  run_elementwise(state, ELT_ADD);
+}
+BENCHMARK(BM_Add)->Apply(elementwise_args);
+
+static void BM_Mul(benchmark::State &state) {
+  run_elementwise(state, ELT_MUL);
+}
+BENCHMARK(BM_Mul)->Apply(elementwise_args);
+
+static void BM_Relu(benchmark::State &state) {
+  run_elementwise(state, ELT_RELU);
+}
+BENCHMARK(BM_Relu)->Apply(elementwise_args);
+
+// Batch normalization of (HW, HW, C, N) buffers, which is only supported for
+// FP16. Every element takes a subtraction, division, multiplication and
+// addition.
+static void BM_BN(benchmark::State &state) {
+  int hw = static_cast<int>(state.range(0));
+  int c = static_cast<int>(state.range(1));
+  int n = static_cast<int>(state.range(2));
+  PimSession session(state.range(3));
+
+  PimBo *input = PimCreateBo(hw, hw, c, n, PIM_FP16, MEM_TYPE_PIM);
+  PimBo *output = PimCreateBo(hw, hw, c, n, PIM_FP16, MEM_TYPE_PIM);
+  PimBo *params[4];
+  for (PimBo *&param : params) {
+    param = PimCreateBo(1, 1, c, 1, PIM_FP16, MEM_TYPE_PIM);
+    fill(param, 1.0f);
+  }
+  fill(input, 2.0f);
+  for (auto _ : state) {
+    PimExecuteBN(output, input, params[0], params[1], params[2], params[3],
+                 1e-5, nullptr, true);
+    benchmark::ClobberMemory();
+  }
+  double elements = static_cast<double>(hw) * hw * c * n;
+  set_rates(state, static_cast<double>(input->size + output->size),
+            4 * elements);
+  for (PimBo *bo : {input, output, params[0], params[1], params[2], params[3]})
+    PimDestroyBo(bo);
+}
+BENCHMARK(BM_BN)
+    ->ArgNames({"hw", "c", "n", "threads"})
+    ->Apply([](benchmark::internal::Benchmark *b) {
+      for (int64_t hw : {16, 64})
+        for (int64_t n : {1, 8})
+          for (int64_t threads : thread_counts())
+            b->Args({hw, 64, n, threads});
+    })
+    ->UseRealTime();
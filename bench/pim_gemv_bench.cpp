@@ -0,0 +1,71 @@
+/*
+ * Copyright (C) 2021 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system, or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#include "bench_utilities.h"
+
+// Benchmarks of the GEMV of N vectors of length IN with an OUT x IN matrix,
+// which read the matrix once per batch.
+
+static void run_gemv(benchmark::State &state, bool add) {
+  int in = static_cast<int>(state.range(0));
+  int out = static_cast<int>(state.range(1));
+  int n = static_cast<int>(state.range(2));
+  PimPrecision precision = precision_arg(state.range(3));
+  bool blocked = state.range(4) != 0;
+  PimSession session(state.range(5));
+
+  PimBo *vector = PimCreateBo(in, 1, 1, n, precision, MEM_TYPE_PIM);
+  PimBo *weight = PimCreateBo(in, out, 1, 1, precision, MEM_TYPE_PIM);
+  PimBo *output = PimCreateBo(out, 1, 1, n, precision, MEM_TYPE_PIM);
+  // Small values keep the FP16 sums finite and the INT8 sums unsaturated.
+  fill(vector, 1.0f);
+  fill(weight, precision == PIM_INT8 ? 0.0f : 0.001f);
+  fill(output, 0.0f);
+  PimBo *matrix = blocked ? PimConvertGemvWeight(weight) : weight;
+  void *stream = nullptr;
+  for (auto _ : state) {
+    if (add) {
+      PimExecuteGemvAdd(output, vector, matrix, stream, true);
+    } else {
+      PimExecuteGemv(output, vector, matrix, stream, true);
+    }
+    benchmark::ClobberMemory();
+  }
+  double bytes = static_cast<double>(vector->size + matrix->size +
+                                     (add ? 2 : 1) * output->size);
+  double flops = 2.0 * in * out * n + (add ? 1.0 * out * n : 0.0);
+  set_rates(state, bytes, flops);
+  if (blocked)
+    PimDestroyBo(matrix);
+  for (PimBo *bo : {vector, weight, output})
+    PimDestroyBo(bo);
+}
+
+static void gemv_args(benchmark::internal::Benchmark *b, bool with_blocked) {
+  b->ArgNames({"in", "out", "n", "int8", "blocked", "threads"});
+  const int64_t shapes[][2] = {{1024, 1024}, {4096, 1024}, {4096, 4096}};
+  for (const auto &shape : shapes)
+    for (int64_t n : {1, 8})
+      for (int64_t int8 : {0, 1})
+        for (int64_t blocked = 0; blocked <= (with_blocked ? 1 : 0);
+             blocked++)
+          for (int64_t threads : thread_counts())
+            b->Args({shape[0], shape[1], n, int8, blocked, threads});
+  b->UseRealTime();
+}
+
+static void BM_Gemv(benchmark::State &state) { run_gemv(state, false); }
+BENCHMARK(BM_Gemv)->Apply(
+    [](benchmark::internal::Benchmark *b) { gemv_args(b, true); });
+
+static void BM_GemvAdd(benchmark::State &state) { run_gemv(state, true); }
+BENCHMARK(BM_GemvAdd)->Apply(
+    [](benchmark::internal::Benchmark *b) { gemv_args(b, false); });
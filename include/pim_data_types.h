@@ -65,6 +65,11 @@ typedef enum __PimPrecision {
   PIM_INT8,
 } PimPrecision;
 
+typedef enum __PimDataLayout {
+  PIM_LAYOUT_RAW,
+  PIM_LAYOUT_GEMV_BLOCKED,
+} PimDataLayout;
+
 typedef struct __PimBShape {
   uint32_t w;
   uint32_t h;
@@ -81,6 +86,8 @@ typedef struct __PimBufferObject {
   size_t size;
   void *data;
   bool use_user_ptr;
+  PimDataLayout data_layout;
+  uint32_t device_id;
 } PimBo;
 
 typedef struct __PimDescriptor {
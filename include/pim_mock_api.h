@@ -0,0 +1,544 @@
+/*
+ * Copyright (C) 2021 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system, or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#ifndef _PIM_MOCK_API_H_
+#define _PIM_MOCK_API_H_
+
+#include "pim_runtime_api.h"
+
+namespace pim {
+namespace mock {
+
+/** @file pim_mock_api.h
+ *   @brief Extensions of the PIM API that are specific to PIMMock
+ *
+ * The functions in this header are not part of Samsung's PIMLibrary, they
+ * control how PIMMock emulates PIM on the host CPU.
+ */
+
+/**
+ * @defgroup PIM-Mock-API-Documentation "PIMMock API Documentation"
+ * @{
+ */
+
+/**
+ * @brief Set the number of host threads used to execute PIM operations
+ *
+ * Every device selected with PimSetDevice has its own threads, so this sets
+ * the number of threads per device. Takes effect immediately if PIM is
+ * initialized, otherwise on the next call to PimInitialize. Operations already
+ * running on other host threads finish with the previous threads. A value of 0
+ * selects the default, which is the value of the environment variable
+ * PIMMOCK_NUM_THREADS if set, or the number of hardware threads of the host
+ * (of the NUMA node of the device, see PimGetDeviceNumaNode) otherwise. The
+ * results of all operations are independent of the number of threads.
+ *
+ * @param num_threads number of threads, including the calling thread
+ *
+ * @return success/failure
+ */
+__PIM_API__ int PimSetNumThreads(uint32_t num_threads);
+
+/**
+ * @brief Get the number of host threads used to execute PIM operations
+ *
+ * @return number of threads of the current device, 1 if PIM is not
+ * initialized
+ */
+__PIM_API__ uint32_t PimGetNumThreads(void);
+
+/**
+ * @brief Get the NUMA node of an emulated device
+ *
+ * Buffers allocated while a device is selected with PimSetDevice are placed
+ * on its NUMA node, and the threads executing PIM operations run on the CPUs
+ * of the node, by default as many threads as the node has CPUs. PimInitialize
+ * assigns the nodes given by the environment variable PIMMOCK_DEVICE_NODES, a
+ * comma-separated list of node ids, to the devices round-robin. By default,
+ * the devices are assigned to all nodes with memory if the host has more than
+ * one, and are not placed otherwise.
+ *
+ * @param device_id id of the device
+ *
+ * @return node of the device, -1 if the device is not placed
+ */
+__PIM_API__ int PimGetDeviceNumaNode(uint32_t device_id);
+
+/**
+ * @brief Enable or disable the deferred execution of element-wise operations
+ *
+ * In deferred execution mode, non-blocking element-wise operations (Add, Mul
+ * and Relu) are not enqueued immediately. Adjacent ones on buffers of the
+ * same shape and padding are collected on their stream and executed as a
+ * single fused pass over the elements when their results are needed, i.e.,
+ * when any other operation or copy is issued to the stream, an event is
+ * recorded on it, or it is synchronized. Disabled by default, the results
+ * are identical either way.
+ *
+ * @param enable enable/disable deferred execution
+ *
+ * @return success/failure
+ */
+__PIM_API__ int PimSetDeferredExecution(bool enable);
+
+/**
+ * @brief Get the instruction set of the kernels executing PIM operations
+ *
+ * The kernels of the best instruction set supported by the host are selected
+ * by PimInitialize. The environment variable PIMMOCK_ISA limits the selection
+ * to the given level, one of "scalar", "avx2", "avx512", "avx512vnni" and
+ * "avx512fp16", e.g., to compare the levels on the same host. All levels give
+ * identical results, except for the rounding of FP16 GEMV.
+ *
+ * @return name of the level of the selected kernels
+ */
+__PIM_API__ const char *PimGetKernelIsa(void);
+
+/**
+ * @brief Statistics of the pool allocating the memory of buffers
+ *
+ * Every device has its own pool, which allocates the buffers created while
+ * the device is selected with PimSetDevice. The pools use size classes and
+ * cache freed memory while PIM is initialized, up to the number of bytes
+ * given by the environment variable PIMMOCK_POOL_LIMIT per device (default 1
+ * GiB, 0 disables the cache). The cache is released by PimDeinitialize. Large
+ * buffers of MEM_TYPE_PIM and MEM_TYPE_DEVICE are backed by huge pages if
+ * available. The environment variable PIMMOCK_DEVICE_MEMORY limits the bytes
+ * in use per device while PIM is initialized, buffers beyond the budget fail
+ * to allocate.
+ */
+typedef struct __PimMemoryPoolStats {
+  /** Number of allocations since the start of the process */
+  uint64_t num_allocations;
+  /** Number of allocations served by cached memory */
+  uint64_t num_pool_hits;
+  /** Bytes of allocated memory, rounded up to the size classes */
+  uint64_t bytes_in_use;
+  /** Bytes of freed memory cached for reuse */
+  uint64_t bytes_cached;
+  /** Maximum of bytes_in_use, 0 for no limit */
+  uint64_t bytes_budget;
+} PimMemoryPoolStats;
+
+/**
+ * @brief Get the statistics of the memory pool of the current device
+ *
+ * @param stats statistics, filled by the call
+ *
+ * @return success/failure
+ */
+__PIM_API__ int PimGetMemoryPoolStats(PimMemoryPoolStats *stats);
+
+/**
+ * @brief Statistics of the copy engine executing non-blocking copies
+ *
+ * Every device has its own copy engine, whose threads execute the
+ * non-blocking copies issued while the device is selected, see
+ * PimCopyMemoryAsync. The environment variable PIMMOCK_COPY_THREADS sets the
+ * number of threads per device (default 2, 0 executes the copies on the
+ * threads of the streams).
+ */
+typedef struct __PimCopyEngineStats {
+  /** Number of non-blocking copies completed since the start of the process */
+  uint64_t num_copies;
+  /** Bytes of the completed copies */
+  uint64_t bytes_copied;
+  /** Number of copies issued and not yet completed */
+  uint64_t queue_depth;
+  /** Maximum of queue_depth */
+  uint64_t max_queue_depth;
+  /** Bytes of the copies issued and not yet completed */
+  uint64_t bytes_in_flight;
+} PimCopyEngineStats;
+
+/**
+ * @brief Get the statistics of the copy engine of the current device
+ *
+ * @param stats statistics, filled by the call
+ *
+ * @return success/failure
+ */
+__PIM_API__ int PimGetCopyEngineStats(PimCopyEngineStats *stats);
+
+/**
+ * @brief Copies data from source to destination on a stream
+ *
+ * Like PimCopyMemory, but enqueued on the stream 'stream' of the current
+ * device, like hipMemcpyAsync, see PimSynchronize. The copy is executed by
+ * the copy engine of the device, overlapping with the operations of other
+ * streams. The memory must stay valid until the copy completed.
+ *
+ * @param dst destination address of buffer
+ * @param src source address of buffer
+ * @param size size of buffer to be copied
+ * @param cpy_type type of memory transfer
+ * @param stream void pointer to stream identifier, nullptr for the default
+ * stream
+ *
+ * @return success/failure
+ */
+__PIM_API__ int PimCopyMemoryAsync(void *dst, void *src, size_t size,
+                                   PimMemCpyType cpy_type, void *stream);
+
+/**
+ * @brief Copies data from source buffer object to destination buffer object
+ * on a stream, see PimCopyMemoryAsync
+ */
+__PIM_API__ int PimCopyMemoryAsync(PimBo *dst, PimBo *src,
+                                   PimMemCpyType cpy_type, void *stream);
+
+/**
+ * @brief Copies a rectangular 3D slice on a stream, see PimCopyMemoryAsync
+ *
+ * The parameters are read when the copy is issued.
+ */
+__PIM_API__ int PimCopyMemoryRectAsync(const PimCopy3D *copyParams,
+                                       void *stream);
+
+/**
+ * @brief Statistics of the calls of a function of the PIM API
+ *
+ * The calls of all functions of pim_runtime_api.h are measured by every host
+ * thread, overloads together. The latency of a call is the time until it
+ * returns, i.e., the time to issue the operation for non-blocking calls. The
+ * traffic is counted for operations and copies with valid operands, the
+ * elements are those of the output, or the multiply-adds of GEMV. Measuring
+ * takes no locks and costs tens of nanoseconds per call. If the environment
+ * variable PIMMOCK_API_STATS is set, PimDeinitialize writes the statistics
+ * to the standard error stream if it is "1", or appends them to the file it
+ * names otherwise.
+ */
+typedef struct __PimApiStats {
+  /** Name of the function, e.g., "PimExecuteAdd" */
+  const char *name;
+  /** Number of calls since the start of the process or PimResetApiStats */
+  uint64_t num_calls;
+  /** Total latency of the calls, in nanoseconds */
+  uint64_t total_ns;
+  /** Median latency, rounded up by less than 25% */
+  uint64_t p50_ns;
+  /** 90th percentile of the latency, rounded up by less than 25% */
+  uint64_t p90_ns;
+  /** 99th percentile of the latency, rounded up by less than 25% */
+  uint64_t p99_ns;
+  /** Maximum latency */
+  uint64_t max_ns;
+  /** Bytes read from the operands */
+  uint64_t bytes_read;
+  /** Bytes written to the outputs */
+  uint64_t bytes_written;
+  /** Elements processed */
+  uint64_t num_elements;
+} PimApiStats;
+
+/**
+ * @brief Get the statistics of the calls of all functions of the PIM API
+ *
+ * @param stats array of '*num_stats' statistics, filled by the call with
+ * those of the first functions
+ * @param num_stats capacity of 'stats', set to the number of functions by
+ * the call
+ *
+ * @return success/failure
+ */
+__PIM_API__ int PimGetApiStats(PimApiStats *stats, uint32_t *num_stats);
+
+/**
+ * @brief Reset the statistics of the calls of all functions of the PIM API
+ *
+ * @return success/failure
+ */
+__PIM_API__ int PimResetApiStats(void);
+
+/**
+ * @brief Peaks of the host, the roofs of the roofline model
+ */
+typedef struct __PimMachinePeaks {
+  /** Sustainable memory bandwidth of the STREAM copy and triad, in bytes per
+   * second */
+  double bytes_per_sec;
+  /** FP32 throughput of independent multiply-adds, in FLOP per second */
+  double flops_per_sec;
+} PimMachinePeaks;
+
+/**
+ * @brief Measure the peaks of the host and start the roofline accounting
+ *
+ * The bandwidth and the FP32 throughput are measured with STREAM-like
+ * kernels on the thread pool of the current device, using the kernels of the
+ * ISA reported by PimGetKernelIsa, which takes a fraction of a second. From
+ * then on, the execution time and traffic of every operation and copy are
+ * counted per function of the PIM API, see PimGetRooflineStats. If the
+ * environment variable PIMMOCK_ROOFLINE is set, PimInitialize probes the
+ * peaks, and PimDeinitialize writes the roofline to the standard error
+ * stream if it is "1", or appends it to the file it names otherwise.
+ *
+ * @param peaks set to the measured peaks, may be NULL
+ *
+ * @return success/failure
+ */
+__PIM_API__ int PimProbeMachinePeaks(PimMachinePeaks *peaks);
+
+/**
+ * @brief Executions of the operations of a function of the PIM API, compared
+ * with the roof of the host
+ *
+ * The operations count one FLOP per element for Add, Mul and Relu, four for
+ * BN and two per multiply-add of GEMV, INT8 operations included. Element-wise
+ * operations fused by deferred execution are not counted.
+ */
+typedef struct __PimRooflineStats {
+  /** Name of the function, e.g., "PimExecuteAdd" */
+  const char *name;
+  /** Number of executions since the probe or PimResetApiStats */
+  uint64_t num_executions;
+  /** Total execution time, in nanoseconds */
+  uint64_t total_ns;
+  /** Achieved bandwidth, bytes read plus written per second */
+  double bytes_per_sec;
+  /** Achieved FLOP per second */
+  double flops_per_sec;
+  /** Arithmetic intensity, FLOP per byte */
+  double intensity;
+  /** Achieved fraction of the roof at the intensity of the operations */
+  double roof_fraction;
+  /** Whether the roof is the FLOP peak rather than the bandwidth peak */
+  bool compute_bound;
+} PimRooflineStats;
+
+/**
+ * @brief Get the roofline of the operations of all functions of the PIM API
+ *
+ * @param stats array of '*num_stats' statistics, filled by the call with
+ * those of the first functions
+ * @param num_stats capacity of 'stats', set to the number of functions by
+ * the call
+ *
+ * @return success/failure
+ */
+__PIM_API__ int PimGetRooflineStats(PimRooflineStats *stats,
+                                    uint32_t *num_stats);
+
+/**
+ * @brief Start tracing the activity of PIM
+ *
+ * While tracing, every call of the functions of pim_runtime_api.h is
+ * recorded as a span with the shape, precision and memory type of its
+ * output, as are the operations executed by the threads of the streams, the
+ * thread pools and the copy engines of the devices, each thread on its own
+ * lane. The spans are buffered per thread and written to the file as Chrome
+ * trace events, which chrome://tracing and Perfetto display, when the trace
+ * is flushed or stopped. Every thread buffers up to the number of spans
+ * given by the environment variable PIMMOCK_TRACE_EVENTS (default 16384),
+ * further spans are dropped until the next flush. If the environment
+ * variable PIMMOCK_TRACE is set, PimInitialize starts tracing to the file it
+ * names. PimDeinitialize stops tracing.
+ *
+ * @param path trace file, replaced by the trace
+ *
+ * @return success/failure, failure if the file cannot be created
+ */
+__PIM_API__ int PimStartTrace(const char *path);
+
+/**
+ * @brief Write the spans recorded so far to the trace file
+ *
+ * @return success/failure
+ */
+__PIM_API__ int PimFlushTrace(void);
+
+/**
+ * @brief Write the remaining spans to the trace file and stop tracing
+ *
+ * @return success/failure
+ */
+__PIM_API__ int PimStopTrace(void);
+
+/**
+ * @brief Create a stream of the current device
+ *
+ * Streams are identified by handles chosen by the application, see
+ * PimSynchronize: any pointer identifies a stream of the current device,
+ * which is created on first use, nullptr the default stream. A stream starts
+ * a host thread with its first non-blocking operation and lives until
+ * PimDestroyStream or PimDeinitialize, so applications using many handles
+ * should destroy the streams they no longer use.
+ *
+ * @return handle identifying a new stream until it is destroyed
+ */
+__PIM_API__ void *PimCreateStream(void);
+
+/**
+ * @brief Destroy a stream of the current device
+ *
+ * Waits for the operations of the stream, stops its thread and forgets it.
+ * Events recorded on the stream stay valid. Operations issued to the handle
+ * later create a new stream.
+ *
+ * @param stream stream identifier, not nullptr
+ *
+ * @return success/failure, failure if the stream is capturing
+ */
+__PIM_API__ int PimDestroyStream(void *stream);
+
+/**
+ * @brief Event marking a point in the operations of a stream
+ *
+ * Events order the operations of different streams without synchronizing
+ * the host, e.g., to run the copies of the next batch on one stream while the
+ * GEMV of the current batch runs on another one. An event completes when all
+ * operations issued to its stream before it was recorded completed. Events
+ * which were never recorded are complete.
+ */
+typedef struct __PimEvent PimEvent;
+
+/**
+ * @brief Create an event
+ *
+ * @return event, to be destroyed with PimDestroyEvent
+ */
+__PIM_API__ PimEvent *PimCreateEvent(void);
+
+/**
+ * @brief Destroy an event
+ *
+ * Operations waiting for the event are not affected.
+ *
+ * @param event event to be destroyed
+ *
+ * @return success/failure
+ */
+__PIM_API__ int PimDestroyEvent(PimEvent *event);
+
+/**
+ * @brief Record an event on a stream of the current device
+ *
+ * Replaces any previous recording of the event.
+ *
+ * @param event event to be recorded
+ * @param stream stream identifier, see PimSynchronize. default=nullptr
+ *
+ * @return success/failure, failure if the stream is capturing
+ */
+__PIM_API__ int PimRecordEvent(PimEvent *event, void *stream = nullptr);
+
+/**
+ * @brief Make a stream of the current device wait for an event
+ *
+ * Operations issued to 'stream' after this call start after the event
+ * completed. Returns immediately, the event may belong to a stream of any
+ * device.
+ *
+ * @param stream stream identifier, see PimSynchronize
+ * @param event event to wait for, as recorded at the time of the call
+ *
+ * @return success/failure, failure if the stream is capturing
+ */
+__PIM_API__ int PimStreamWaitEvent(void *stream, PimEvent *event);
+
+/**
+ * @brief Query whether an event completed, without blocking
+ *
+ * @param event event to be queried
+ *
+ * @return 0 if the event completed, 1 if it is pending, negative on failure
+ */
+__PIM_API__ int PimQueryEvent(PimEvent *event);
+
+/**
+ * @brief Block the host thread until an event completed
+ *
+ * @param event event to wait for
+ *
+ * @return success/failure
+ */
+__PIM_API__ int PimSynchronizeEvent(PimEvent *event);
+
+/**
+ * @brief Sequence of operations captured from a stream
+ *
+ * A fixed sequence of operations and copies, e.g., of an inference step, can
+ * be captured once and replayed with a single call. The operands are
+ * validated when the operations are captured, the graph refers to the
+ * memory of the buffers at that time and reads their contents when it runs.
+ * Adjacent element-wise operations (Add, Mul and Relu) on buffers of the same
+ * shape and padding are fused into a single pass over the elements.
+ */
+typedef struct __PimGraph PimGraph;
+
+/**
+ * @brief Start capturing the operations issued to a stream of the current
+ * device
+ *
+ * Until PimEndCapture, operations and copies issued to the stream, blocking
+ * or not, are added to a graph instead of being executed. Graphs hold no
+ * dependencies on other streams: recording an event on the stream and
+ * making it wait for an event fail while it is capturing.
+ *
+ * @param stream stream identifier, see PimSynchronize. default=nullptr
+ *
+ * @return success/failure, failure if the stream is already capturing
+ */
+__PIM_API__ int PimBeginCapture(void *stream = nullptr);
+
+/**
+ * @brief Stop capturing a stream and return the captured graph
+ *
+ * @param stream stream identifier, see PimSynchronize. default=nullptr
+ *
+ * @return graph, to be destroyed with PimDestroyGraph, nullptr if the stream
+ * is not capturing
+ */
+__PIM_API__ PimGraph *PimEndCapture(void *stream = nullptr);
+
+/**
+ * @brief Run a graph on a stream of the current device
+ *
+ * The graph runs like a single operation issued to the stream.
+ *
+ * @param graph graph to run
+ * @param stream stream identifier, see PimSynchronize. default=nullptr
+ * @param block enable/disable synchronization. default=false
+ *
+ * @return success/failure
+ */
+__PIM_API__ int PimLaunchGraph(PimGraph *graph, void *stream = nullptr,
+                               bool block = false);
+
+/**
+ * @brief Get the number of nodes of a graph
+ *
+ * Every node executes one captured operation, or several fused element-wise
+ * operations.
+ *
+ * @param graph graph
+ *
+ * @return number of nodes
+ */
+__PIM_API__ uint32_t PimGetGraphNumNodes(PimGraph *graph);
+
+/**
+ * @brief Destroy a graph
+ *
+ * Runs of the graph which are still pending are not affected.
+ *
+ * @param graph graph to be destroyed
+ *
+ * @return success/failure
+ */
+__PIM_API__ int PimDestroyGraph(PimGraph *graph);
+
+/**@}*/
+
+} // namespace mock
+} // namespace pim
+
+#endif /* _PIM_MOCK_API_H_ */
@@ -62,6 +62,12 @@ __PIM_API__ int PimDeinitialize(void);
  * @brief Set PimDevice for Execution
  *
  * This call set the current device for execution to device id
+ *
+ * The device is selected per host thread, device 0 by default. Every device
+ * has its own memory pool and threads: buffers created while the device is
+ * selected belong to it (PimBo::device_id), and operations run on its
+ * threads, so host threads driving different devices run concurrently.
+ * PIMMock emulates up to 64 devices.
  * @return Return success/failure
  *
  */
@@ -85,12 +91,16 @@ __PIM_API__ PimBo *PimCreateBo(int w, int h, int c, int n,
 /**
  * @brief Create PIM buffer object with pim descriptor
  *
+ * The bshape of the buffer is its logical shape, bshape_r the shape of its
+ * storage, whose rows are padded as in the descriptor, see PimCreateDesc.
+ *
  * @param pim_desc PIM descriptor
  * @param mem_type type of memory need to be allocated (PIM/GPU/HOST)
  * @param mem_flag Describes operation for which buffer is used for( element
  * wise or gemv)
  * @param user_ptr external memory passed by user. If passed, Bo is created with
- * user pointer. if nullptr, pim library does the allocation
+ * user pointer, which must hold the padded storage. if nullptr, pim library
+ * does the allocation
  * @return Pointer to buffer object
  */
 __PIM_API__ PimBo *PimCreateBo(PimDesc *pim_desc, PimMemType mem_type,
@@ -109,6 +119,12 @@ __PIM_API__ int PimDestroyBo(PimBo *pim_bo);
 /**
  * @brief Create PIM descriptor using parameters passed
  *
+ * bshape_r of the descriptor is bshape with the rows padded to a multiple of
+ * the buffer alignment (64 bytes by default), i.e., w, and for OP_GEMV also
+ * h, the length of the output rows and of the columns of transposed weights.
+ * Element-wise operations and copies also accept buffers that differ from
+ * each other only in the padding.
+ *
  * @param n number of batches
  * @param c number of channels
  * @param h height of buffer
@@ -174,6 +190,9 @@ __PIM_API__ int PimFreeMemory(PimBo *pim_bo);
 /**
  * @brief Copies data from source to destination
  *
+ * The copy waits for all previously issued operations of the involved
+ * devices. PimCopyMemoryAsync of pim_mock_api.h copies on a stream instead.
+ *
  * @param dst destination address of buffer
  * @param src source address of buffer
  * @param size size of buffer to be copied
@@ -188,6 +207,8 @@ __PIM_API__ int PimCopyMemory(void *dst, void *src, size_t size,
 /**
  * @brief Copies data from source buffer object o destination buffer object
  *
+ * See PimCopyMemory for the ordering of the copy.
+ *
  * @param dst destination buffer object
  * @param src source buffer object
  * @param cpy_type type of memory transfer (HOST to GPU, GPU to HOST, GPU to PIM
@@ -200,6 +221,8 @@ __PIM_API__ int PimCopyMemory(PimBo *dst, PimBo *src, PimMemCpyType cpy_type);
 /**
  * @brief Copies a rectangular 3D slice between source and destination.
  *
+ * See PimCopyMemory for the ordering of the copy.
+ *
  * @param copyParams Parameters for the rectangular copy.
  * @return success/failure
  */
@@ -208,7 +231,8 @@ __PIM_API__ int PimCopyMemoryRect(const PimCopy3D *copyParams);
 /**
  * @brief Execute Add vector operation on PIM
  *
- * Executes add operations using PIM buffer objects
+ * Executes add operations using PIM buffer objects. All operands must have the
+ * same precision. PIM_INT8 sums saturate to [-128, 127].
  *
  * @param output output Buffer object
  * @param operand0 input 1 of add operations- conveted data
@@ -224,10 +248,12 @@ __PIM_API__ int PimExecuteAdd(PimBo *output, PimBo *operand0, PimBo *operand1,
 /**
  * @brief Execute add scalar operation on PIM
  *
- * Executes add scalar operation using PIM
+ * Executes add scalar operation using PIM. PIM_INT8 sums saturate to
+ * [-128, 127].
  *
  * @param output output buffer object
- * @param scalar scalar value to be added
+ * @param scalar scalar value to be added, a half for PIM_FP16 buffers and an
+ * int8_t for PIM_INT8 buffers
  * @param vector input vector for add operations
  *
  * @return success/failure
@@ -238,6 +264,9 @@ __PIM_API__ int PimExecuteAdd(PimBo *output, void *scalar, PimBo *vector,
 /**
  * @brief Executes Mul vector operation in PIM
  *
+ * All operands must have the same precision. PIM_INT8 products saturate to
+ * [-128, 127].
+ *
  * @param output output buffer object
  * @param operand0 first operand for Mul operations ( converted data)
  * @param operand1 second operand for Mul Operations.
@@ -252,8 +281,11 @@ __PIM_API__ int PimExecuteMul(PimBo *output, PimBo *operand0, PimBo *operand1,
 /**
  * @brief Executes Mul Scalar operation in PIM
  *
+ * PIM_INT8 products saturate to [-128, 127].
+ *
  * @param output output buffer object
- * @param scalar scalar value to be multiplied to vector
+ * @param scalar scalar value to be multiplied to vector, a half for PIM_FP16
+ * buffers and an int8_t for PIM_INT8 buffers
  * @param vector vector input
  * @param stream void pointer to stream identifier. default=nullptr
  * @param block enable/disable synchronization. default=false
@@ -276,12 +308,40 @@ __PIM_API__ int PimExecuteMul(PimBo *output, void *scalar, PimBo *vector,
 __PIM_API__ int PimExecuteRelu(PimBo *output, PimBo *pim_data,
                                void *stream = nullptr, bool block = false);
 
+/**
+ * @brief Converts GEMV weights into the layout used by the GEMV kernels
+ *
+ * Creates a copy of the weight matrix 'weight', with the layout (X, Y, C, 1)
+ * of GEMV_WEIGHT or GEMV_WEIGHT_T buffers, in which the weights are stored in
+ * the blocks the GEMV kernels process, aligned to cache lines. The returned
+ * buffer object records this layout in its data_layout member and can be
+ * passed as the matrix of all GEMV operations, which then read the weights
+ * sequentially. Results are identical to those computed with the weights in
+ * row-major layout.
+ *
+ * Converted buffer objects can only be used as GEMV weights, copied to
+ * other converted buffer objects of the same shape and destroyed.
+ *
+ * @param weight buffer object with the weights in row-major or, if the 't'
+ * flag of its shape is set, column-major layout
+ *
+ * @return Pointer to the converted buffer object, nullptr on failure
+ */
+__PIM_API__ PimBo *PimConvertGemvWeight(PimBo *weight);
+
 /**
  * @brief Executes PIM GEMV operation
  *
  * This API provides interface for PIM GEMV operations.
  * For PIM GemV operations, weights(kernel values) need to be preprocessed with
- Convert Data PIM API
+ Convert Data PIM API. The mock also accepts unconverted weights, but is faster
+ with weights converted by PimConvertGemvWeight. GEMV_WEIGHT_T weights, i.e.,
+ matrices stored column-major with the 't' flag of their shape set, are
+ supported directly.
+ * All operands must have the same precision. For PIM_INT8, the products are
+ accumulated exactly in INT32, and each output value is saturated to
+ [-128, 127] only after the addend and ReLU of PimExecuteGemvAdd are applied.
+ This also holds for PimExecuteGemvAdd and PimExecuteGemvList.
  * Output values are placed in PIM area and need to be transfered to GPU or HOST
  memory as per requirements
  *
@@ -354,6 +414,8 @@ __PIM_API__ int PimExecuteGemvList(PimBo *output, PimBo *vector, PimBo *matrix,
 /**
  * @brief Executes Batch normalization operation.
  *
+ * Only PIM_FP16 buffers are supported.
+ *
  * @param output output buffer object for BN operation
  * @param pim_data input buffer object ( Should be of PIM Area)
  * @param beta Pim Buffer object having beta values for BN operation
@@ -376,7 +438,19 @@ __PIM_API__ int PimExecuteBN(PimBo *output, PimBo *pim_data, PimBo *beta,
  *
  * This API blocks execution until all previously issues commands are completed
  *
- * @return
+ * Operations with block=false are enqueued on the stream identified by their
+ * stream argument, a handle chosen by the application, and return
+ * immediately. The operations of a stream run in order, the streams of a
+ * device run concurrently. Operations with block=true also run after the
+ * operations enqueued on their stream before, on the default stream
+ * (nullptr) after those of all streams of the device, like on the legacy
+ * default stream of HIP, and return when completed.
+ * Copies and frees of memory wait for all operations of the involved devices.
+ *
+ * @param stream stream to wait for, nullptr for all streams of the current
+ * device
+ *
+ * @return success/failure
  */
 __PIM_API__ int PimSynchronize(void *stream = nullptr);
 
@@ -0,0 +1,316 @@
+/*
+ * Copyright (C) 2021 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system, or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#include "pim_api_stats.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace pim {
+namespace mock {
+
+namespace {
+
+constexpr size_t LATENCY_SUB_BITS = 2;
+static_assert(LATENCY_SUB_BUCKETS == size_t{1} << LATENCY_SUB_BITS,
+              "Inconsistent latency buckets");
+
+using Counter = std::atomic<uint64_t>;
+
+// Counters of the calls of one function by one thread. Only the thread
+// writes them, with plain loads and stores, other threads read them while
+// they are written.
+struct FunctionCounters {
+  Counter calls;
+  Counter totalNs;
+  Counter maxNs;
+  Counter bytesRead;
+  Counter bytesWritten;
+  Counter elements;
+  std::array<Counter, NUM_LATENCY_BUCKETS> latency;
+  Counter executions;
+  Counter executionNs;
+  Counter executedBytes;
+  Counter executedElements;
+};
+
+struct ThreadCounters {
+  // The epoch of ResetApiStats the counters belong to, counters of older
+  // epochs are zeroed by their thread on its next call.
+  std::atomic<uint64_t> epoch{0};
+  std::array<FunctionCounters, NUM_API_FUNCTIONS> functions;
+};
+
+// The counters of all threads, and the sums of the counters of threads which
+// exited. Leaked, so that threads may exit after static destruction.
+struct Registry {
+  std::mutex mutex;
+  std::vector<ThreadCounters *> threads;
+  ApiStats retired;
+  std::atomic<uint64_t> epoch{0};
+};
+
+Registry &GetRegistry() {
+  static Registry *registry = new Registry;
+  return *registry;
+}
+
+void Increment(Counter &counter, uint64_t value) {
+  counter.store(counter.load(std::memory_order_relaxed) + value,
+                std::memory_order_relaxed);
+}
+
+void Zero(ThreadCounters &counters) {
+  for (FunctionCounters &function : counters.functions) {
+    for (Counter *counter :
+         {&function.calls, &function.totalNs, &function.maxNs,
+          &function.bytesRead, &function.bytesWritten, &function.elements,
+          &function.executions, &function.executionNs,
+          &function.executedBytes, &function.executedElements}) {
+      counter->store(0, std::memory_order_relaxed);
+    }
+    for (Counter &bucket : function.latency) {
+      bucket.store(0, std::memory_order_relaxed);
+    }
+  }
+}
+
+void Accumulate(const ThreadCounters &counters, ApiStats &stats) {
+  for (size_t f = 0; f < NUM_API_FUNCTIONS; ++f) {
+    const FunctionCounters &function = counters.functions[f];
+    ApiFunctionStats &sum = stats[f];
+    sum.calls += function.calls.load(std::memory_order_relaxed);
+    sum.totalNs += function.totalNs.load(std::memory_order_relaxed);
+    sum.maxNs =
+        std::max(sum.maxNs, function.maxNs.load(std::memory_order_relaxed));
+    sum.bytesRead += function.bytesRead.load(std::memory_order_relaxed);
+    sum.bytesWritten += function.bytesWritten.load(std::memory_order_relaxed);
+    sum.elements += function.elements.load(std::memory_order_relaxed);
+    for (size_t b = 0; b < NUM_LATENCY_BUCKETS; ++b) {
+      sum.latency[b] += function.latency[b].load(std::memory_order_relaxed);
+    }
+    sum.executions += function.executions.load(std::memory_order_relaxed);
+    sum.executionNs += function.executionNs.load(std::memory_order_relaxed);
+    sum.executedBytes +=
+        function.executedBytes.load(std::memory_order_relaxed);
+    sum.executedElements +=
+        function.executedElements.load(std::memory_order_relaxed);
+  }
+}
+
+// Registers the counters of a thread on its first call, and adds them to the
+// retired counters when the thread exits.
+class ThreadRegistration {
+public:
+  ThreadRegistration() : counters(new ThreadCounters()) {
+    Registry &registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    counters->epoch.store(registry.epoch.load(std::memory_order_relaxed),
+                          std::memory_order_relaxed);
+    registry.threads.push_back(counters.get());
+  }
+
+  ~ThreadRegistration() {
+    Registry &registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    if (counters->epoch.load(std::memory_order_relaxed) ==
+        registry.epoch.load(std::memory_order_relaxed)) {
+      Accumulate(*counters, registry.retired);
+    }
+    registry.threads.erase(std::find(registry.threads.begin(),
+                                     registry.threads.end(), counters.get()));
+  }
+
+  ThreadCounters &Counters() { return *counters; }
+
+private:
+  std::unique_ptr<ThreadCounters> counters;
+};
+
+// The counters of the calling thread, zeroed first if ResetApiStats was
+// called since the thread last counted.
+ThreadCounters &LocalCounters() {
+  thread_local ThreadRegistration registration;
+  ThreadCounters &counters = registration.Counters();
+  uint64_t epoch = GetRegistry().epoch.load(std::memory_order_acquire);
+  if (counters.epoch.load(std::memory_order_relaxed) != epoch) {
+    Zero(counters);
+    counters.epoch.store(epoch, std::memory_order_release);
+  }
+  return counters;
+}
+
+thread_local const ApiCall *currentCall = nullptr;
+
+// Buckets 0 to 3 hold 0 to 3 ns, the following buckets split every power of
+// two into four.
+size_t LatencyBucket(uint64_t ns) {
+  if (ns < LATENCY_SUB_BUCKETS) {
+    return ns;
+  }
+  size_t log2 = 63 - __builtin_clzll(ns);
+  size_t sub = (ns >> (log2 - LATENCY_SUB_BITS)) & (LATENCY_SUB_BUCKETS - 1);
+  return (log2 - LATENCY_SUB_BITS + 1) * LATENCY_SUB_BUCKETS + sub;
+}
+
+// The largest latency of the bucket 'bucket'.
+uint64_t LatencyBucketLimit(size_t bucket) {
+  if (bucket < LATENCY_SUB_BUCKETS) {
+    return bucket;
+  }
+  size_t shift = bucket / LATENCY_SUB_BUCKETS - 1;
+  uint64_t sub = bucket % LATENCY_SUB_BUCKETS;
+  return ((LATENCY_SUB_BUCKETS + sub + 1) << shift) - 1;
+}
+
+constexpr const char *API_FUNCTION_NAMES[] = {
+    "PimInitialize",        "PimDeinitialize",    "PimSetDevice",
+    "PimCreateBo",          "PimDestroyBo",       "PimCreateDesc",
+    "PimDestroyDesc",       "PimAllocMemory",     "PimFreeMemory",
+    "PimCopyMemory",        "PimCopyMemoryRect",  "PimExecuteAdd",
+    "PimExecuteMul",        "PimExecuteRelu",     "PimConvertGemvWeight",
+    "PimExecuteGemv",       "PimExecuteGemvAdd",  "PimExecuteGemvList",
+    "PimExecuteBN",         "PimSynchronize",     "PimExecuteDummy"};
+static_assert(sizeof(API_FUNCTION_NAMES) / sizeof(API_FUNCTION_NAMES[0]) ==
+                  NUM_API_FUNCTIONS,
+              "Missing API function names");
+
+} // anonymous namespace
+
+const char *ApiFunctionName(ApiFunction function) {
+  return API_FUNCTION_NAMES[static_cast<size_t>(function)];
+}
+
+uint64_t ApiFunctionStats::LatencyPercentile(double p) const {
+  if (!calls) {
+    return 0;
+  }
+  uint64_t rank = std::max<uint64_t>(
+      static_cast<uint64_t>(std::ceil(p * static_cast<double>(calls))), 1);
+  uint64_t count = 0;
+  for (size_t b = 0; b < NUM_LATENCY_BUCKETS; ++b) {
+    count += latency[b];
+    if (count >= rank) {
+      return std::min(LatencyBucketLimit(b), maxNs);
+    }
+  }
+  return maxNs;
+}
+
+ApiCall::ApiCall(ApiFunction function)
+    : function(function), start(TraceClock::now()), outer(currentCall) {
+  currentCall = this;
+}
+
+ApiCall::~ApiCall() {
+  currentCall = outer;
+  TraceClock::time_point end = TraceClock::now();
+  TraceSpan(Name(), start, end, args);
+  uint64_t ns =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
+          .count();
+  ThreadCounters &counters = LocalCounters();
+  FunctionCounters &function =
+      counters.functions[static_cast<size_t>(this->function)];
+  Increment(function.calls, 1);
+  Increment(function.totalNs, ns);
+  if (ns > function.maxNs.load(std::memory_order_relaxed)) {
+    function.maxNs.store(ns, std::memory_order_relaxed);
+  }
+  Increment(function.bytesRead, args.bytesRead);
+  Increment(function.bytesWritten, args.bytesWritten);
+  Increment(function.elements, args.elements);
+  Increment(function.latency[LatencyBucket(ns)], 1);
+}
+
+const ApiCall *CurrentApiCall() { return currentCall; }
+
+void CountExecution(ApiFunction function, uint64_t ns,
+                    const TraceArgs &args) {
+  FunctionCounters &counters =
+      LocalCounters().functions[static_cast<size_t>(function)];
+  Increment(counters.executions, 1);
+  Increment(counters.executionNs, ns);
+  Increment(counters.executedBytes, args.bytesRead + args.bytesWritten);
+  Increment(counters.executedElements, args.elements);
+}
+
+ApiStats GetApiStats() {
+  Registry &registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  ApiStats stats = registry.retired;
+  uint64_t epoch = registry.epoch.load(std::memory_order_relaxed);
+  for (const ThreadCounters *counters : registry.threads) {
+    // Counters of older epochs were not zeroed yet.
+    if (counters->epoch.load(std::memory_order_acquire) == epoch) {
+      Accumulate(*counters, stats);
+    }
+  }
+  return stats;
+}
+
+void ResetApiStats() {
+  Registry &registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  registry.retired = ApiStats{};
+  registry.epoch.fetch_add(1, std::memory_order_release);
+}
+
+void DumpApiStats(std::FILE *out) {
+  ApiStats stats = GetApiStats();
+  std::fprintf(out,
+               "%-22s %10s %12s %10s %10s %10s %10s %12s %12s %14s\n",
+               "PIMMock API", "calls", "total [ms]", "p50 [us]", "p90 [us]",
+               "p99 [us]", "max [us]", "read [MB]", "written [MB]",
+               "elements");
+  for (size_t f = 0; f < NUM_API_FUNCTIONS; ++f) {
+    const ApiFunctionStats &function = stats[f];
+    if (!function.calls) {
+      continue;
+    }
+    std::fprintf(
+        out,
+        "%-22s %10llu %12.3f %10.2f %10.2f %10.2f %10.2f %12.2f %12.2f "
+        "%14llu\n",
+        ApiFunctionName(static_cast<ApiFunction>(f)),
+        static_cast<unsigned long long>(function.calls),
+        function.totalNs * 1e-6, function.LatencyPercentile(0.5) * 1e-3,
+        function.LatencyPercentile(0.9) * 1e-3,
+        function.LatencyPercentile(0.99) * 1e-3, function.maxNs * 1e-3,
+        function.bytesRead * 1e-6, function.bytesWritten * 1e-6,
+        static_cast<unsigned long long>(function.elements));
+  }
+  std::fflush(out);
+}
+
+void DumpApiStatsIfRequested() {
+  const char *env = std::getenv("PIMMOCK_API_STATS");
+  if (!env || !*env || std::strcmp(env, "0") == 0) {
+    return;
+  }
+  if (std::strcmp(env, "1") == 0) {
+    DumpApiStats(stderr);
+    return;
+  }
+  if (std::FILE *file = std::fopen(env, "a")) {
+    DumpApiStats(file);
+    std::fclose(file);
+  }
+}
+
+} // namespace mock
+} // namespace pim
@@ -0,0 +1,148 @@
+/*
+ * Copyright (C) 2021 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system, or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#ifndef _PIM_API_STATS_H_
+#define _PIM_API_STATS_H_
+
+#include "pim_trace.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+namespace pim {
+namespace mock {
+
+// Public functions of the runtime API whose calls are measured, see ApiCall.
+// Overloads are measured together.
+enum class ApiFunction {
+  INITIALIZE,
+  DEINITIALIZE,
+  SET_DEVICE,
+  CREATE_BO,
+  DESTROY_BO,
+  CREATE_DESC,
+  DESTROY_DESC,
+  ALLOC_MEMORY,
+  FREE_MEMORY,
+  COPY_MEMORY,
+  COPY_MEMORY_RECT,
+  EXECUTE_ADD,
+  EXECUTE_MUL,
+  EXECUTE_RELU,
+  CONVERT_GEMV_WEIGHT,
+  EXECUTE_GEMV,
+  EXECUTE_GEMV_ADD,
+  EXECUTE_GEMV_LIST,
+  EXECUTE_BN,
+  SYNCHRONIZE,
+  EXECUTE_DUMMY,
+  COUNT
+};
+
+constexpr size_t NUM_API_FUNCTIONS = static_cast<size_t>(ApiFunction::COUNT);
+
+// The name of 'function' in the API, e.g., "PimExecuteAdd".
+const char *ApiFunctionName(ApiFunction function);
+
+// Latencies are counted in a histogram of buckets of nanoseconds with four
+// buckets per power of two, so percentiles are accurate to within 25%.
+constexpr size_t LATENCY_SUB_BUCKETS = 4;
+constexpr size_t NUM_LATENCY_BUCKETS = 63 * LATENCY_SUB_BUCKETS;
+
+// Statistics of the calls of one function.
+struct ApiFunctionStats {
+  uint64_t calls = 0;
+  uint64_t totalNs = 0;
+  uint64_t maxNs = 0;
+  uint64_t bytesRead = 0;
+  uint64_t bytesWritten = 0;
+  uint64_t elements = 0;
+  std::array<uint64_t, NUM_LATENCY_BUCKETS> latency{};
+  // The executions of the operations issued by the calls, counted by
+  // CountExecution, with their total duration and traffic.
+  uint64_t executions = 0;
+  uint64_t executionNs = 0;
+  uint64_t executedBytes = 0;
+  uint64_t executedElements = 0;
+
+  // The latency below which the fraction 'p' of the calls completed, rounded
+  // up to the bucket, 0 without calls.
+  uint64_t LatencyPercentile(double p) const;
+};
+
+// Measures a call of 'function' on the calling thread, from construction to
+// destruction, and counts it with the traffic set by SetTraffic. The
+// counters are kept per thread and only written by their thread, so
+// measuring takes no locks and no atomic read-modify-write operations. If
+// tracing is enabled, the call is also recorded as a span, see TraceSpan.
+class ApiCall {
+public:
+  explicit ApiCall(ApiFunction function);
+  ~ApiCall();
+
+  ApiCall(const ApiCall &) = delete;
+  ApiCall &operator=(const ApiCall &) = delete;
+
+  // The bytes of memory the call reads and writes, and the number of
+  // elements it processes.
+  void SetTraffic(uint64_t read, uint64_t written, uint64_t numElements) {
+    args.bytesRead = read;
+    args.bytesWritten = written;
+    args.elements = numElements;
+  }
+
+  // The buffer whose shape, precision and memory type are traced, usually
+  // the output. nullptr is ignored.
+  void SetBuffer(const PimBo *bo) { args.SetBuffer(bo); }
+
+  ApiFunction Function() const { return function; }
+
+  const char *Name() const { return ApiFunctionName(function); }
+
+  const TraceArgs &Args() const { return args; }
+
+private:
+  ApiFunction function;
+  TraceClock::time_point start;
+  TraceArgs args;
+  const ApiCall *outer;
+};
+
+// The innermost call measured on the calling thread, nullptr outside of
+// calls.
+const ApiCall *CurrentApiCall();
+
+// Counts an execution of an operation issued by a call of 'function' with
+// the traffic 'args', which took 'ns' on the calling thread, e.g., a stream
+// thread. Like ApiCall, takes no locks.
+void CountExecution(ApiFunction function, uint64_t ns, const TraceArgs &args);
+
+using ApiStats = std::array<ApiFunctionStats, NUM_API_FUNCTIONS>;
+
+// The statistics of the calls of all threads since the start of the process
+// or the last call to ResetApiStats, indexed by ApiFunction.
+ApiStats GetApiStats();
+
+void ResetApiStats();
+
+// Writes GetApiStats as a table of the functions called to 'out'.
+void DumpApiStats(std::FILE *out);
+
+// Dumps the statistics if requested by the environment variable
+// PIMMOCK_API_STATS, to the standard error stream if it is "1", or appended
+// to the file it names otherwise. Called by PimDeinitialize.
+void DumpApiStatsIfRequested();
+
+} // namespace mock
+} // namespace pim
+
+#endif /* _PIM_API_STATS_H_ */
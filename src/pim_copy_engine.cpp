@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2021 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system, or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#include "pim_copy_engine.h"
+
+#include "pim_numa.h"
+#include "pim_trace.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace pim {
+namespace mock {
+
+void RowCopy::Run(size_t begin, size_t end) const {
+  for (size_t row = begin; row < end; ++row) {
+    size_t d = row / height;
+    size_t h = row % height;
+    std::memcpy(dst + d * dstPlanePitch + h * dstPitch,
+                src + d * srcPlanePitch + h * srcPitch, rowBytes);
+  }
+}
+
+void CopyEngine::Start(size_t numThreads, int node) {
+  Stop();
+  std::lock_guard<std::mutex> lock(mutex);
+  stop = false;
+  for (size_t i = 0; i < numThreads; ++i) {
+    workers.emplace_back([this, node] { WorkerLoop(node); });
+  }
+}
+
+void CopyEngine::Stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stop = true;
+  }
+  wakeCondition.notify_all();
+  for (auto &worker : workers) {
+    worker.join();
+  }
+  workers.clear();
+}
+
+void CopyEngine::Issue(size_t bytes) {
+  std::lock_guard<std::mutex> lock(mutex);
+  ++stats.queueDepth;
+  stats.bytesInFlight += bytes;
+  stats.maxQueueDepth = std::max(stats.maxQueueDepth, stats.queueDepth);
+}
+
+void CopyEngine::Execute(const RowCopy &copy) {
+  Job job{&copy};
+  std::unique_lock<std::mutex> lock(mutex);
+  if (workers.empty() || stop) {
+    lock.unlock();
+    copy.Run(0, copy.numRows);
+    lock.lock();
+  } else {
+    queue.push_back(&job);
+    wakeCondition.notify_one();
+    doneCondition.wait(lock, [&job] { return job.done; });
+  }
+  ++stats.copies;
+  stats.bytes += copy.Bytes();
+  --stats.queueDepth;
+  stats.bytesInFlight -= copy.Bytes();
+}
+
+CopyEngine::Stats CopyEngine::GetStats() {
+  std::lock_guard<std::mutex> lock(mutex);
+  return stats;
+}
+
+void CopyEngine::WorkerLoop(int node) {
+  BindThreadToNode(node);
+  SetTraceLane("copy engine", device);
+  std::unique_lock<std::mutex> lock(mutex);
+  for (;;) {
+    // Copies queued before the engine is stopped still run.
+    wakeCondition.wait(lock, [this] { return stop || !queue.empty(); });
+    if (queue.empty()) {
+      return;
+    }
+    Job *job = queue.front();
+    queue.pop_front();
+    lock.unlock();
+    {
+      TraceArgs args;
+      args.bytesRead = args.bytesWritten = job->copy->Bytes();
+      TraceScope span("Copy", args);
+      job->copy->Run(0, job->copy->numRows);
+    }
+    lock.lock();
+    job->done = true;
+    doneCondition.notify_all();
+  }
+}
+
+size_t DefaultCopyThreads() {
+  if (const char *env = std::getenv("PIMMOCK_COPY_THREADS")) {
+    char *end = nullptr;
+    unsigned long value = std::strtoul(env, &end, 10);
+    if (end != env && *end == '\0') {
+      return value;
+    }
+  }
+  return 2;
+}
+
+} // namespace mock
+} // namespace pim
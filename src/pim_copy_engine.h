@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2021 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system, or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#ifndef _PIM_COPY_ENGINE_H_
+#define _PIM_COPY_ENGINE_H_
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace pim {
+namespace mock {
+
+// Copy of 'numRows' rows of 'rowBytes' bytes. The rows form planes of
+// 'height' rows, row h of plane d starts at byte d * planePitch + h * pitch
+// of the destination and the source, respectively. Contiguous copies are a
+// single row.
+struct RowCopy {
+  char *dst;
+  const char *src;
+  size_t rowBytes;
+  size_t numRows = 1;
+  size_t height = 1;
+  size_t dstPitch = 0;
+  size_t srcPitch = 0;
+  size_t dstPlanePitch = 0;
+  size_t srcPlanePitch = 0;
+
+  size_t Bytes() const { return rowBytes * numRows; }
+
+  // Copies the rows [begin, end).
+  void Run(size_t begin, size_t end) const;
+};
+
+// Copy engine of an emulated device, the counterpart of the DMA engines of a
+// GPU. Asynchronous copies are executed by the threads of the engine instead
+// of the thread pool of the device, so that they overlap with operations of
+// other streams using the pool. The streams issue the copies in their order
+// and wait for them, so the engine only adds concurrency between streams.
+class CopyEngine {
+public:
+  struct Stats {
+    // Copies executed, and their bytes.
+    uint64_t copies = 0;
+    uint64_t bytes = 0;
+    // Copies issued and not completed, including those still queued on
+    // their stream, their bytes, and the maximum of queueDepth.
+    size_t queueDepth = 0;
+    size_t bytesInFlight = 0;
+    size_t maxQueueDepth = 0;
+  };
+
+  // The threads are traced as threads of the device 'device', see
+  // SetTraceLane.
+  explicit CopyEngine(int device = -1) : device(device) {}
+  ~CopyEngine() { Stop(); }
+
+  CopyEngine(const CopyEngine &) = delete;
+  CopyEngine &operator=(const CopyEngine &) = delete;
+
+  // Starts 'numThreads' threads on the NUMA node 'node', unless it is -1,
+  // replacing any running threads.
+  void Start(size_t numThreads, int node);
+
+  // Waits for all queued copies and stops the threads.
+  void Stop();
+
+  // Counts a copy of 'bytes' bytes issued to a stream, to be passed to
+  // Execute.
+  void Issue(size_t bytes);
+
+  // Executes the issued 'copy' on a thread of the engine, or on the calling
+  // thread if the engine is stopped, and returns when it completed.
+  void Execute(const RowCopy &copy);
+
+  Stats GetStats();
+
+private:
+  struct Job {
+    const RowCopy *copy;
+    bool done = false;
+  };
+
+  void WorkerLoop(int node);
+
+  int device;
+  std::vector<std::thread> workers;
+
+  std::mutex mutex;
+  std::condition_variable wakeCondition;
+  std::condition_variable doneCondition;
+  std::deque<Job *> queue;
+  bool stop = false;
+  Stats stats;
+};
+
+// Number of threads of the copy engine of every device: the value of the
+// environment variable PIMMOCK_COPY_THREADS if set, 2 otherwise, as GPUs
+// have separate engines for both directions.
+size_t DefaultCopyThreads();
+
+} // namespace mock
+} // namespace pim
+
+#endif /* _PIM_COPY_ENGINE_H_ */
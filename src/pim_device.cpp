@@ -0,0 +1,220 @@
+/*
+ * Copyright (C) 2021 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system, or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#include "pim_device.h"
+
+#include "pim_numa.h"
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cstdlib>
+#include <mutex>
+#include <vector>
+
+namespace pim {
+namespace mock {
+
+namespace {
+
+// Devices are created under the mutex, but looked up without locking.
+std::mutex devicesMutex;
+std::array<std::atomic<DeviceContext *>, MAX_DEVICES> devices{};
+
+// Configuration of started devices, applied to devices created later.
+bool started = false;
+size_t startedThreads = 0;
+size_t startedCopyThreads = 0;
+size_t startedCacheLimit = 0;
+size_t startedBudget = SIZE_MAX;
+
+thread_local uint32_t currentDevice = 0;
+
+void StartDevice(DeviceContext &device) {
+  device.Memory().SetCacheLimit(startedCacheLimit);
+  device.Memory().SetBudget(startedBudget);
+  device.StartThreads(startedThreads);
+  device.Copies().Start(startedCopyThreads, DeviceNumaNode(device.Id()));
+}
+
+} // anonymous namespace
+
+void DeviceContext::StartThreads(size_t numThreads) {
+  int node = DeviceNumaNode(id);
+  if (!numThreads) {
+    numThreads = DefaultNumThreads(node);
+  }
+  // The operations of the streams use the pool.
+  SynchronizeStreams();
+  // Release the old pool first, to not temporarily run twice the threads
+  // unless another host thread is still using it.
+  std::atomic_store(&threads, {});
+  std::atomic_store(&threads,
+                    std::make_shared<ThreadPool>(numThreads, node, id));
+}
+
+std::shared_ptr<Stream> DeviceContext::GetStream(void *handle) {
+  std::lock_guard<std::mutex> lock(streamsMutex);
+  std::shared_ptr<Stream> &stream = streams[handle];
+  if (!stream) {
+    stream = std::make_shared<Stream>(id);
+  }
+  return stream;
+}
+
+void *DeviceContext::CreateStream() {
+  auto stream = std::make_shared<Stream>(id);
+  void *handle = stream.get();
+  std::lock_guard<std::mutex> lock(streamsMutex);
+  streams[handle] = std::move(stream);
+  return handle;
+}
+
+bool DeviceContext::DestroyStream(void *handle) {
+  std::shared_ptr<Stream> stream;
+  {
+    std::lock_guard<std::mutex> lock(streamsMutex);
+    auto entry = streams.find(handle);
+    if (entry == streams.end()) {
+      return true;
+    }
+    if (entry->second->Capturing()) {
+      return false;
+    }
+    stream = std::move(entry->second);
+    streams.erase(entry);
+  }
+  // Events recorded on the stream may keep it, but its thread ends now.
+  stream->Stop();
+  return true;
+}
+
+void DeviceContext::SynchronizeStreams() {
+  // Waits without the lock, to let other host threads issue meanwhile.
+  std::vector<std::shared_ptr<Stream>> current;
+  {
+    std::lock_guard<std::mutex> lock(streamsMutex);
+    for (auto &entry : streams) {
+      current.push_back(entry.second);
+    }
+  }
+  for (auto &stream : current) {
+    stream->Synchronize();
+  }
+}
+
+void DeviceContext::StopStreams() {
+  std::vector<std::shared_ptr<Stream>> stopped;
+  {
+    std::lock_guard<std::mutex> lock(streamsMutex);
+    for (auto &entry : streams) {
+      stopped.push_back(std::move(entry.second));
+    }
+    streams.clear();
+  }
+  for (auto &stream : stopped) {
+    stream->Stop();
+  }
+}
+
+DeviceContext &GetDevice(uint32_t id) {
+  assert(id < MAX_DEVICES && "Device not valid");
+  if (DeviceContext *device = devices[id].load(std::memory_order_acquire)) {
+    return *device;
+  }
+  std::lock_guard<std::mutex> lock(devicesMutex);
+  DeviceContext *device = devices[id].load(std::memory_order_relaxed);
+  if (!device) {
+    device = new DeviceContext(id);
+    if (started) {
+      StartDevice(*device);
+    }
+    devices[id].store(device, std::memory_order_release);
+  }
+  return *device;
+}
+
+void SetCurrentDevice(uint32_t id) { currentDevice = id; }
+
+DeviceContext &CurrentDevice() { return GetDevice(currentDevice); }
+
+void StartDevices(size_t numThreads, size_t copyThreads, size_t cacheLimit,
+                  size_t budget) {
+  std::lock_guard<std::mutex> lock(devicesMutex);
+  started = true;
+  startedThreads = numThreads;
+  startedCopyThreads = copyThreads;
+  startedCacheLimit = cacheLimit;
+  startedBudget = budget;
+  for (auto &slot : devices) {
+    if (DeviceContext *device = slot.load(std::memory_order_relaxed)) {
+      StartDevice(*device);
+    }
+  }
+}
+
+void SetDeviceThreads(size_t numThreads) {
+  std::lock_guard<std::mutex> lock(devicesMutex);
+  if (!started) {
+    return;
+  }
+  startedThreads = numThreads;
+  for (auto &slot : devices) {
+    if (DeviceContext *device = slot.load(std::memory_order_relaxed)) {
+      device->StartThreads(numThreads);
+    }
+  }
+}
+
+void StopDevices() {
+  std::lock_guard<std::mutex> lock(devicesMutex);
+  started = false;
+  for (auto &slot : devices) {
+    if (DeviceContext *device = slot.load(std::memory_order_relaxed)) {
+      device->StopStreams();
+      device->Copies().Stop();
+      device->StopThreads();
+      // Buffers freed from now on are released immediately.
+      device->Memory().SetCacheLimit(0);
+      device->Memory().SetBudget(SIZE_MAX);
+    }
+  }
+}
+
+bool FreeDeviceMemory(void *ptr) {
+  if (!ptr) {
+    return true;
+  }
+  for (auto &slot : devices) {
+    DeviceContext *device = slot.load(std::memory_order_acquire);
+    if (device && device->Memory().Free(ptr)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+size_t DefaultDeviceMemory() {
+  if (const char *env = std::getenv("PIMMOCK_DEVICE_MEMORY")) {
+    char *end = nullptr;
+    unsigned long long value = std::strtoull(env, &end, 10);
+    if (end != env && *end == '\0' && value > 0) {
+      return value;
+    }
+  }
+  return SIZE_MAX;
+}
+
+std::shared_ptr<ThreadPool> CurrentThreadPool() {
+  return CurrentDevice().Threads();
+}
+
+} // namespace mock
+} // namespace pim
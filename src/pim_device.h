@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 2021 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system, or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#ifndef _PIM_DEVICE_H_
+#define _PIM_DEVICE_H_
+
+#include "pim_copy_engine.h"
+#include "pim_memory_pool.h"
+#include "pim_stream.h"
+#include "pim_thread_pool.h"
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace pim {
+namespace mock {
+
+// Maximum number of emulated devices.
+constexpr uint32_t MAX_DEVICES = 64;
+
+// Context of an emulated device, which owns the resources of the device: the
+// memory pool holding its buffers, the thread pool executing its operations
+// and the copy engine executing its asynchronous copies, whose threads run on
+// the NUMA node of the device, and the streams queueing its operations.
+// Contexts are created on first use and never destroyed, so buffers may be
+// freed at any time.
+class DeviceContext {
+public:
+  explicit DeviceContext(uint32_t id) : id(id), copies(id) {}
+
+  DeviceContext(const DeviceContext &) = delete;
+  DeviceContext &operator=(const DeviceContext &) = delete;
+
+  uint32_t Id() const { return id; }
+
+  MemoryPool &Memory() { return memory; }
+
+  // The thread pool of the device, nullptr if PIM is not initialized. Callers
+  // keep the returned reference while using the pool, so that a concurrent
+  // StartThreads or StopThreads does not destroy it under them.
+  std::shared_ptr<ThreadPool> Threads() { return std::atomic_load(&threads); }
+
+  // Starts the thread pool with 'numThreads' threads, 0 for the default of
+  // the device's node, replacing any running pool after waiting for the
+  // operations of all streams.
+  void StartThreads(size_t numThreads);
+
+  void StopThreads() { std::atomic_store(&threads, {}); }
+
+  CopyEngine &Copies() { return copies; }
+
+  // The stream identified by the application's handle 'handle', created on
+  // first use. nullptr identifies the default stream. Events keep the streams
+  // they are recorded on.
+  std::shared_ptr<Stream> GetStream(void *handle);
+
+  // Creates a stream and returns its handle, the address of the stream, which
+  // identifies it until it is destroyed.
+  void *CreateStream();
+
+  // Waits for the operations of the stream 'handle', stops it and forgets
+  // it, if it exists. Fails if the stream is capturing.
+  bool DestroyStream(void *handle);
+
+  // Waits for the operations of all streams.
+  void SynchronizeStreams();
+
+  // Waits for the operations of all streams, stops them and forgets them.
+  void StopStreams();
+
+private:
+  uint32_t id;
+  MemoryPool memory;
+  // Accessed with the atomic shared_ptr functions.
+  std::shared_ptr<ThreadPool> threads;
+  CopyEngine copies;
+  std::mutex streamsMutex;
+  std::map<void *, std::shared_ptr<Stream>> streams;
+};
+
+// The context of the device 'id' < MAX_DEVICES, created on first use.
+DeviceContext &GetDevice(uint32_t id);
+
+// Selects the device of the calling host thread. Every host thread starts
+// with device 0.
+void SetCurrentDevice(uint32_t id);
+
+// The context of the device selected by the calling host thread.
+DeviceContext &CurrentDevice();
+
+// Starts the thread pools of all devices, including devices created later,
+// with 'numThreads' threads each, and their copy engines with 'copyThreads'
+// threads each, and sets the cache limit and the memory budget of their
+// memory pools. Called by PimInitialize.
+void StartDevices(size_t numThreads, size_t copyThreads, size_t cacheLimit,
+                  size_t budget);
+
+// Restarts the thread pools of all devices with 'numThreads' threads, if the
+// devices are started.
+void SetDeviceThreads(size_t numThreads);
+
+// Waits for the operations of all devices, destroys their streams, stops
+// their copy engines and thread pools and releases their cached memory.
+// Called by PimDeinitialize.
+void StopDevices();
+
+// Frees 'ptr' allocated by the memory pool of any device. Returns false if no
+// device allocated 'ptr'.
+bool FreeDeviceMemory(void *ptr);
+
+// Memory budget of every device while PIM is initialized: the value of the
+// environment variable PIMMOCK_DEVICE_MEMORY in bytes if set, unlimited
+// otherwise.
+size_t DefaultDeviceMemory();
+
+} // namespace mock
+} // namespace pim
+
+#endif /* _PIM_DEVICE_H_ */
@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2021 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system, or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#include "pim_graph.h"
+
+#include "pim_thread_pool.h"
+#include "pim_trace.h"
+#include <algorithm>
+#include <utility>
+
+namespace pim {
+namespace mock {
+
+namespace {
+
+// Elements per block of fused operations. Blocks of 16 KiB of FP16 elements
+// of a few buffers fit into the L2 cache of all current x86 cores.
+constexpr size_t FUSION_BLOCK = 8 * 1024;
+
+bool Overlap(const MemoryRange &a, const MemoryRange &b) {
+  return a.begin < b.begin + b.size && b.begin < a.begin + a.size;
+}
+
+} // anonymous namespace
+
+bool CanFuse(const std::vector<Operation> &group, const Operation &op) {
+  if (!op.IsElementwise()) {
+    return false;
+  }
+  for (const Operation &member : group) {
+    if (!member.IsElementwise() || member.numElements != op.numElements ||
+        member.elementSize != op.elementSize) {
+      return false;
+    }
+    for (const MemoryRange &a : member.buffers) {
+      for (const MemoryRange &b : op.buffers) {
+        bool same = a.begin == b.begin && a.size == b.size;
+        if (a.size && b.size && !same && Overlap(a, b)) {
+          return false;
+        }
+      }
+    }
+  }
+  return true;
+}
+
+std::function<void()> FuseOperations(std::vector<Operation> group) {
+  if (group.size() == 1) {
+    return std::move(group.front().run);
+  }
+  return [group = std::move(group)] {
+    const Operation &first = group.front();
+    TraceArgs args;
+    args.elements = first.numElements * group.size();
+    TraceScope span("FusedElementwise", args);
+    ParallelFor(first.numElements, first.grain, first.align,
+                [&](size_t begin, size_t end) {
+                  for (size_t block = begin; block < end;
+                       block += FUSION_BLOCK) {
+                    size_t blockEnd = std::min(block + FUSION_BLOCK, end);
+                    for (const Operation &op : group) {
+                      op.runRange(block, blockEnd);
+                    }
+                  }
+                });
+  };
+}
+
+void Graph::Finalize() {
+  nodes = std::make_shared<std::vector<std::function<void()>>>();
+  std::vector<Operation> group;
+  for (Operation &op : captured) {
+    if (!group.empty() && !CanFuse(group, op)) {
+      nodes->push_back(FuseOperations(std::move(group)));
+      group.clear();
+    }
+    group.push_back(std::move(op));
+  }
+  if (!group.empty()) {
+    nodes->push_back(FuseOperations(std::move(group)));
+  }
+  captured.clear();
+}
+
+std::function<void()> Graph::Runner() const {
+  return [nodes = nodes] {
+    if (nodes) {
+      for (const auto &node : *nodes) {
+        node();
+      }
+    }
+  };
+}
+
+} // namespace mock
+} // namespace pim
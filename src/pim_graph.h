@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2021 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system, or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#ifndef _PIM_GRAPH_H_
+#define _PIM_GRAPH_H_
+
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace pim {
+namespace mock {
+
+// Memory of a buffer used by an operation.
+struct MemoryRange {
+  const char *begin = nullptr;
+  size_t size = 0;
+};
+
+// An operation issued to a stream, validated when issued and executed by
+// 'run'. Element-wise operations whose buffers all have the same storage
+// also provide 'runRange', which processes the elements [begin, end) of all
+// buffers on the calling thread, so that adjacent ones can be fused. 'run'
+// splits the elements across the thread pool with 'grain' and 'align', see
+// ParallelFor.
+struct Operation {
+  std::function<void()> run;
+  std::function<void(size_t, size_t)> runRange;
+  size_t numElements = 0;
+  size_t elementSize = 0;
+  size_t grain = 1;
+  size_t align = 1;
+  std::array<MemoryRange, 3> buffers{};
+
+  bool IsElementwise() const { return static_cast<bool>(runRange); }
+};
+
+// Whether 'op' can be fused with the element-wise operations 'group', i.e.,
+// processing all of them block by block gives the same result as processing
+// them one after the other. This holds if they process the same number of
+// elements of the same size and every pair of their buffers is either the
+// same or disjoint, so that each element only depends on elements at the
+// same offset.
+bool CanFuse(const std::vector<Operation> &group, const Operation &op);
+
+// Returns a function executing the element-wise operations 'group' in a
+// single pass over the elements, distributed across the thread pool like
+// the first operation: every thread applies all operations to one
+// cache-sized block of elements after the other, so the intermediate
+// results stay in the cache. A group of one operation is executed by its
+// 'run'.
+std::function<void()> FuseOperations(std::vector<Operation> group);
+
+// Sequence of operations captured from a stream, see PimBeginCapture.
+// Adjacent element-wise operations are fused when the capture ends.
+class Graph {
+public:
+  void Add(Operation op) { captured.push_back(std::move(op)); }
+
+  // Builds the nodes from the captured operations.
+  void Finalize();
+
+  size_t NumNodes() const { return nodes ? nodes->size() : 0; }
+
+  // Function running all nodes in order, which stays valid after the graph
+  // is destroyed.
+  std::function<void()> Runner() const;
+
+private:
+  std::vector<Operation> captured;
+  std::shared_ptr<std::vector<std::function<void()>>> nodes;
+};
+
+} // namespace mock
+} // namespace pim
+
+#endif /* _PIM_GRAPH_H_ */
@@ -0,0 +1,490 @@
+/*
+ * Copyright (C) 2021 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system, or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#include "pim_kernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+namespace pim {
+namespace mock {
+namespace kernels {
+
+namespace scalar {
+
+void Add(half_t *out, const half_t *in0, const half_t *in1, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    out[i] = in0[i] + in1[i];
+  }
+}
+
+void AddScalar(half_t *out, const half_t *in, half_t value, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    out[i] = in[i] + value;
+  }
+}
+
+void Mul(half_t *out, const half_t *in0, const half_t *in1, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    out[i] = in0[i] * in1[i];
+  }
+}
+
+void MulScalar(half_t *out, const half_t *in, half_t value, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    out[i] = in[i] * value;
+  }
+}
+
+void Relu(half_t *out, const half_t *in, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    out[i] = (half_float::signbit(in[i])) ? 0.0 : in[i];
+  }
+}
+
+void BatchNorm(half_t *out, const half_t *in, half_t mean, half_t divisor,
+               half_t gamma, half_t beta, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    half_t norm = (in[i] - mean) / divisor;
+    out[i] = gamma * norm + beta;
+  }
+}
+
+void GemvTile(float *acc, size_t accStride, const half_t *mat, size_t ld,
+              const float *vec, size_t vecStride, size_t numVecs,
+              size_t numRows, size_t kc) {
+  for (size_t r = 0; r < numRows; ++r) {
+    const half_t *row = mat + r * ld;
+    for (size_t v = 0; v < numVecs; ++v) {
+      const float *x = vec + v * vecStride;
+      float sum = 0.0f;
+      for (size_t i = 0; i < kc; ++i) {
+        sum += static_cast<float>(row[i]) * x[i];
+      }
+      acc[v * accStride + r] += sum;
+    }
+  }
+}
+
+namespace {
+
+inline int8_t SaturateInt8(int32_t value) {
+  return static_cast<int8_t>(std::min(std::max(value, -128), 127));
+}
+
+} // anonymous namespace
+
+void AddInt8(int8_t *out, const int8_t *in0, const int8_t *in1, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    out[i] = SaturateInt8(int32_t{in0[i]} + in1[i]);
+  }
+}
+
+void AddScalarInt8(int8_t *out, const int8_t *in, int8_t value, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    out[i] = SaturateInt8(int32_t{in[i]} + value);
+  }
+}
+
+void MulInt8(int8_t *out, const int8_t *in0, const int8_t *in1, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    out[i] = SaturateInt8(int32_t{in0[i]} * in1[i]);
+  }
+}
+
+void MulScalarInt8(int8_t *out, const int8_t *in, int8_t value, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    out[i] = SaturateInt8(int32_t{in[i]} * value);
+  }
+}
+
+void ReluInt8(int8_t *out, const int8_t *in, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    out[i] = std::max<int8_t>(in[i], 0);
+  }
+}
+
+void GemvTileInt8(int32_t *acc, size_t accStride, const int8_t *mat, size_t ld,
+                  const int8_t *vec, size_t vecStride, size_t numVecs,
+                  size_t numRows, size_t kc) {
+  for (size_t r = 0; r < numRows; ++r) {
+    const int8_t *row = mat + r * ld;
+    for (size_t v = 0; v < numVecs; ++v) {
+      const int8_t *x = vec + v * vecStride;
+      int32_t sum = 0;
+      for (size_t i = 0; i < kc; ++i) {
+        sum += int32_t{row[i]} * x[i];
+      }
+      acc[v * accStride + r] += sum;
+    }
+  }
+}
+
+void GemvTileT(float *acc, size_t accStride, const half_t *mat, size_t ld,
+               const float *vec, size_t vecStride, size_t numVecs,
+               size_t numRows, size_t kc) {
+  for (size_t v = 0; v < numVecs; ++v) {
+    const float *x = vec + v * vecStride;
+    for (size_t r = 0; r < numRows; ++r) {
+      float sum = 0.0f;
+      for (size_t i = 0; i < kc; ++i) {
+        sum += static_cast<float>(mat[i * ld + r]) * x[i];
+      }
+      acc[v * accStride + r] += sum;
+    }
+  }
+}
+
+void GemvTileTInt8(int32_t *acc, size_t accStride, const int8_t *mat,
+                   size_t ld, const int8_t *vec, size_t vecStride,
+                   size_t numVecs, size_t numRows, size_t kc) {
+  for (size_t v = 0; v < numVecs; ++v) {
+    const int8_t *x = vec + v * vecStride;
+    for (size_t r = 0; r < numRows; ++r) {
+      int32_t sum = 0;
+      for (size_t i = 0; i < kc; ++i) {
+        sum += int32_t{mat[i * ld + r]} * x[i];
+      }
+      acc[v * accStride + r] += sum;
+    }
+  }
+}
+
+uint64_t FmaProbe(size_t iterations, float *sink) {
+  constexpr size_t CHAINS = 16;
+  float acc[CHAINS];
+  for (size_t c = 0; c < CHAINS; ++c) {
+    acc[c] = static_cast<float>(c);
+  }
+  for (size_t i = 0; i < iterations; ++i) {
+    for (size_t c = 0; c < CHAINS; ++c) {
+      acc[c] = acc[c] * 0.999999f + 1e-7f;
+    }
+  }
+  float sum = 0;
+  for (size_t c = 0; c < CHAINS; ++c) {
+    sum += acc[c];
+  }
+  *sink = sum;
+  return uint64_t{2} * CHAINS * iterations;
+}
+
+} // namespace scalar
+
+namespace {
+
+// The ISA levels of SelectKernels, in increasing order of preference.
+enum IsaLevel : size_t {
+  ISA_SCALAR,
+  ISA_AVX2,
+  ISA_AVX512,
+  ISA_AVX512VNNI,
+  ISA_AVX512FP16,
+  NUM_ISA_LEVELS,
+};
+
+const char *const ISA_NAMES[NUM_ISA_LEVELS] = {"scalar", "avx2", "avx512",
+                                               "avx512vnni", "avx512fp16"};
+
+size_t MaxIsaLevel(const char *maxIsa) {
+  for (size_t level = 0; maxIsa && level < NUM_ISA_LEVELS; ++level) {
+    if (std::strcmp(maxIsa, ISA_NAMES[level]) == 0) {
+      return level;
+    }
+  }
+  return NUM_ISA_LEVELS - 1;
+}
+
+// Starts from the scalar kernels and replaces them with the kernels of each
+// ISA supported by the host, in increasing order of preference, up to the ISA
+// level 'maxLevel'.
+KernelTable BestKernels(size_t maxLevel) {
+  KernelTable table{"scalar",
+                    scalar::Add,
+                    scalar::AddScalar,
+                    scalar::Mul,
+                    scalar::MulScalar,
+                    scalar::GemvTile,
+                    scalar::AddInt8,
+                    scalar::AddScalarInt8,
+                    scalar::MulInt8,
+                    scalar::MulScalarInt8,
+                    scalar::GemvTileInt8,
+                    scalar::GemvTileT,
+                    scalar::GemvTileTInt8,
+                    scalar::Relu,
+                    scalar::BatchNorm,
+                    scalar::ReluInt8,
+                    scalar::FmaProbe};
+#if defined(PIMMOCK_HAVE_AVX2)
+  if (maxLevel >= ISA_AVX2 && __builtin_cpu_supports("avx2") &&
+      __builtin_cpu_supports("f16c") && __builtin_cpu_supports("fma")) {
+    table = {"avx2",
+             avx2::Add,
+             avx2::AddScalar,
+             avx2::Mul,
+             avx2::MulScalar,
+             avx2::GemvTile,
+             avx2::AddInt8,
+             avx2::AddScalarInt8,
+             avx2::MulInt8,
+             avx2::MulScalarInt8,
+             avx2::GemvTileInt8,
+             avx2::GemvTileT,
+             avx2::GemvTileTInt8,
+             avx2::Relu,
+             avx2::BatchNorm,
+             avx2::ReluInt8,
+             avx2::FmaProbe};
+  }
+#endif
+#if defined(PIMMOCK_HAVE_AVX512)
+  bool hasAvx512 = maxLevel >= ISA_AVX512 &&
+                   __builtin_cpu_supports("avx512f") &&
+                   __builtin_cpu_supports("avx512bw") &&
+                   __builtin_cpu_supports("avx512vl");
+  if (hasAvx512) {
+    table = {"avx512",
+             avx512::Add,
+             avx512::AddScalar,
+             avx512::Mul,
+             avx512::MulScalar,
+             avx512::GemvTile,
+             avx512::AddInt8,
+             avx512::AddScalarInt8,
+             avx512::MulInt8,
+             avx512::MulScalarInt8,
+             avx512::GemvTileInt8,
+             avx512::GemvTileT,
+             avx512::GemvTileTInt8,
+             avx512::Relu,
+             avx512::BatchNorm,
+             avx512::ReluInt8,
+             avx512::FmaProbe};
+  }
+#if defined(PIMMOCK_HAVE_AVX512VNNI)
+  if (hasAvx512 && maxLevel >= ISA_AVX512VNNI &&
+      __builtin_cpu_supports("avx512vnni")) {
+    table.isa = "avx512vnni";
+    table.gemvTileInt8 = avx512vnni::GemvTileInt8;
+  }
+#endif
+#if defined(PIMMOCK_HAVE_AVX512FP16)
+  if (hasAvx512 && maxLevel >= ISA_AVX512FP16 &&
+      __builtin_cpu_supports("avx512fp16")) {
+    table.isa = "avx512fp16";
+    table.add = avx512fp16::Add;
+    table.addScalar = avx512fp16::AddScalar;
+    table.mul = avx512fp16::Mul;
+    table.mulScalar = avx512fp16::MulScalar;
+  }
+#endif
+#endif
+  return table;
+}
+
+KernelTable &SelectedKernels() {
+  static KernelTable table = BestKernels(NUM_ISA_LEVELS - 1);
+  return table;
+}
+
+} // anonymous namespace
+
+void SelectKernels(const char *maxIsa) {
+  SelectedKernels() = BestKernels(MaxIsaLevel(maxIsa));
+}
+
+const KernelTable &GetKernels() { return SelectedKernels(); }
+
+namespace {
+
+constexpr size_t CACHE_LINE = 64;
+
+// Returns the tile of GEMV weights at row 'r0' and column 'k0', with 'rows'
+// rows and 'kc' columns, and stores its leading dimension in 'tileLd'.
+template <typename T>
+const T *GemvTileAt(const T *mat, size_t ld, GemvLayout layout, size_t r0,
+                    size_t rows, size_t k0, size_t kc, size_t *tileLd) {
+  switch (layout) {
+  case GemvLayout::TRANSPOSED:
+    *tileLd = ld;
+    return mat + k0 * ld + r0;
+  case GemvLayout::BLOCKED:
+    // All tiles of a panel before column k0 are GEMV_K_TILE wide and
+    // unpadded.
+    *tileLd = BlockedGemvLd(kc, sizeof(T));
+    return mat + r0 * ld + rows * k0;
+  case GemvLayout::ROW_MAJOR:
+  default:
+    *tileLd = ld;
+    return mat + r0 * ld + k0;
+  }
+}
+
+// Copies the transposed tile at row 'r0' and column 'k0' of the column-major
+// matrix 'src' into the row-major tile 'dst'.
+template <typename T>
+void TransposeTile(T *dst, size_t dstLd, const T *src, size_t srcLd, size_t r0,
+                   size_t rows, size_t k0, size_t kc) {
+  for (size_t r = 0; r < rows; ++r) {
+    for (size_t i = 0; i < kc; ++i) {
+      dst[r * dstLd + i] = src[(k0 + i) * srcLd + r0 + r];
+    }
+  }
+}
+
+} // anonymous namespace
+
+size_t BlockedGemvLd(size_t k, size_t elementSize) {
+  static_assert(GEMV_K_TILE % CACHE_LINE == 0,
+                "GEMV_K_TILE must be a multiple of the cache line size");
+  size_t lineElements = CACHE_LINE / elementSize;
+  return (k + lineElements - 1) / lineElements * lineElements;
+}
+
+void PackGemvWeights(void *dst, const void *src, size_t srcLd, size_t numRows,
+                     size_t k, size_t elementSize, bool transposed) {
+  size_t ld = BlockedGemvLd(k, elementSize);
+  auto *dstBytes = static_cast<char *>(dst);
+  const auto *srcBytes = static_cast<const char *>(src);
+  for (size_t r0 = 0; r0 < numRows; r0 += GEMV_ROW_TILE) {
+    size_t rows = std::min(GEMV_ROW_TILE, numRows - r0);
+    for (size_t k0 = 0; k0 < k; k0 += GEMV_K_TILE) {
+      size_t kc = std::min(GEMV_K_TILE, k - k0);
+      size_t tileLd = BlockedGemvLd(kc, elementSize);
+      char *tile = dstBytes + (r0 * ld + rows * k0) * elementSize;
+      for (size_t r = 0; r < rows; ++r) {
+        char *row = tile + r * tileLd * elementSize;
+        if (!transposed) {
+          std::memcpy(row, srcBytes + ((r0 + r) * srcLd + k0) * elementSize,
+                      kc * elementSize);
+        }
+        std::memset(row + kc * elementSize, 0, (tileLd - kc) * elementSize);
+      }
+      if (transposed && elementSize == sizeof(uint16_t)) {
+        TransposeTile(reinterpret_cast<uint16_t *>(tile), tileLd,
+                      static_cast<const uint16_t *>(src), srcLd, r0, rows,
+                      k0, kc);
+      } else if (transposed) {
+        TransposeTile(reinterpret_cast<uint8_t *>(tile), tileLd,
+                      static_cast<const uint8_t *>(src), srcLd, r0, rows,
+                      k0, kc);
+      }
+    }
+  }
+}
+
+void Gemv(half_t *out, size_t outStride, const half_t *mat, size_t ld,
+          GemvLayout layout, const half_t *vec, size_t vecStride,
+          size_t numVecs, size_t numRows, size_t k,
+          const GemvEpilogue<half_t> &epilogue) {
+  bool transposed = layout == GemvLayout::TRANSPOSED;
+  size_t rowTile = transposed ? GEMV_T_ROW_TILE : GEMV_ROW_TILE;
+  size_t kTile = transposed ? GEMV_T_K_TILE : GEMV_K_TILE;
+  // The FP32 copies of the vectors and the accumulators are kept per thread,
+  // to not allocate memory on every call.
+  thread_local std::vector<float> vecFloat;
+  thread_local std::vector<float> acc;
+  // The vectors are padded by a cache line, as a power of two stride would
+  // map the same elements of all vectors to the same L1 set.
+  size_t vecFloatStride = (k + 15) / 16 * 16 + 16;
+  if (vecFloat.size() < numVecs * vecFloatStride) {
+    vecFloat.resize(numVecs * vecFloatStride);
+  }
+  if (acc.size() < numVecs * rowTile) {
+    acc.resize(numVecs * rowTile);
+  }
+  for (size_t v = 0; v < numVecs; ++v) {
+    for (size_t i = 0; i < k; ++i) {
+      vecFloat[v * vecFloatStride + i] =
+          static_cast<float>(vec[v * vecStride + i]);
+    }
+  }
+
+  GemvTileFn gemvTile = layout == GemvLayout::TRANSPOSED
+                            ? GetKernels().gemvTileT
+                            : GetKernels().gemvTile;
+  for (size_t r0 = 0; r0 < numRows; r0 += rowTile) {
+    size_t rows = std::min(rowTile, numRows - r0);
+    std::fill(acc.begin(), acc.begin() + numVecs * rowTile, 0.0f);
+    for (size_t k0 = 0; k0 < k; k0 += kTile) {
+      size_t kc = std::min(kTile, k - k0);
+      size_t tileLd;
+      const half_t *tile =
+          GemvTileAt(mat, ld, layout, r0, rows, k0, kc, &tileLd);
+      gemvTile(acc.data(), rowTile, tile, tileLd, vecFloat.data() + k0,
+               vecFloatStride, numVecs, rows, kc);
+    }
+    for (size_t v = 0; v < numVecs; ++v) {
+      for (size_t r = 0; r < rows; ++r) {
+        size_t index = v * outStride + r0 + r;
+        float result = acc[v * rowTile + r];
+        if (epilogue.addend) {
+          result += static_cast<float>(
+              epilogue.addend[v * epilogue.addendStride + r0 + r]);
+        }
+        if (epilogue.relu && std::signbit(result)) {
+          result = 0.0f;
+        }
+        out[index] = half_t(result);
+      }
+    }
+  }
+}
+
+void Gemv(int8_t *out, size_t outStride, const int8_t *mat, size_t ld,
+          GemvLayout layout, const int8_t *vec, size_t vecStride,
+          size_t numVecs, size_t numRows, size_t k,
+          const GemvEpilogue<int8_t> &epilogue) {
+  bool transposed = layout == GemvLayout::TRANSPOSED;
+  size_t rowTile = transposed ? GEMV_T_ROW_TILE : GEMV_ROW_TILE;
+  size_t kTile = transposed ? GEMV_T_K_TILE : GEMV_K_TILE;
+  thread_local std::vector<int32_t> acc;
+  if (acc.size() < numVecs * rowTile) {
+    acc.resize(numVecs * rowTile);
+  }
+
+  GemvTileInt8Fn gemvTile = layout == GemvLayout::TRANSPOSED
+                                ? GetKernels().gemvTileTInt8
+                                : GetKernels().gemvTileInt8;
+  for (size_t r0 = 0; r0 < numRows; r0 += rowTile) {
+    size_t rows = std::min(rowTile, numRows - r0);
+    std::fill(acc.begin(), acc.begin() + numVecs * rowTile, 0);
+    for (size_t k0 = 0; k0 < k; k0 += kTile) {
+      size_t kc = std::min(kTile, k - k0);
+      size_t tileLd;
+      const int8_t *tile =
+          GemvTileAt(mat, ld, layout, r0, rows, k0, kc, &tileLd);
+      gemvTile(acc.data(), rowTile, tile, tileLd, vec + k0, vecStride,
+               numVecs, rows, kc);
+    }
+    for (size_t v = 0; v < numVecs; ++v) {
+      for (size_t r = 0; r < rows; ++r) {
+        size_t index = v * outStride + r0 + r;
+        int64_t result = acc[v * rowTile + r];
+        if (epilogue.addend) {
+          result += epilogue.addend[v * epilogue.addendStride + r0 + r];
+        }
+        if (epilogue.relu && result < 0) {
+          result = 0;
+        }
+        out[index] = static_cast<int8_t>(
+            std::min<int64_t>(std::max<int64_t>(result, -128), 127));
+      }
+    }
+  }
+}
+
+} // namespace kernels
+} // namespace mock
+} // namespace pim
@@ -0,0 +1,290 @@
+/*
+ * Copyright (C) 2021 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system, or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#ifndef _PIM_KERNELS_H_
+#define _PIM_KERNELS_H_
+
+#include "half.hpp"
+#include <cstddef>
+#include <cstdint>
+
+using half_t = half_float::half;
+
+namespace pim {
+namespace mock {
+namespace kernels {
+
+// Element-wise FP16 kernels. All kernels process the elements [0, count) and
+// must produce results that are bit-identical to the scalar implementation
+// using half_t, i.e., a single round-to-nearest-even rounding to FP16.
+using EltBinaryFn = void (*)(half_t *out, const half_t *in0, const half_t *in1,
+                             size_t count);
+using EltScalarFn = void (*)(half_t *out, const half_t *in, half_t value,
+                             size_t count);
+
+// ReLU with the semantics of PimExecuteRelu: +0 for inputs with the sign bit
+// set, the input otherwise.
+using ReluFn = void (*)(half_t *out, const half_t *in, size_t count);
+
+// Batch normalization of one plane of PimExecuteBN,
+// out[i] = gamma * ((in[i] - mean) / divisor) + beta, with every operation
+// rounded to FP16 like the half_t operations.
+using BatchNormFn = void (*)(half_t *out, const half_t *in, half_t mean,
+                             half_t divisor, half_t gamma, half_t beta,
+                             size_t count);
+
+// GEMV micro-kernel on one cache tile: for all rows r in [0, numRows) and
+// vectors v in [0, numVecs),
+// acc[v * accStride + r] += dot(mat[r * ld, r * ld + kc),
+//                               vec[v * vecStride, v * vecStride + kc)),
+// with the FP16 matrix converted to FP32 and all products accumulated in FP32.
+// Each matrix element is loaded once for all vectors. The result for a row and
+// vector does not depend on numRows or numVecs. The transposed micro-kernels
+// have the same signature, but read the matrix column-major, i.e., row r is
+// mat[r], mat[ld + r], ..., mat[(kc - 1) * ld + r], and vectorize across rows.
+using GemvTileFn = void (*)(float *acc, size_t accStride, const half_t *mat,
+                            size_t ld, const float *vec, size_t vecStride,
+                            size_t numVecs, size_t numRows, size_t kc);
+
+// Element-wise INT8 kernels with saturating arithmetic, i.e., the exact result
+// clamped to [-128, 127].
+using EltBinaryInt8Fn = void (*)(int8_t *out, const int8_t *in0,
+                                 const int8_t *in1, size_t count);
+using EltScalarInt8Fn = void (*)(int8_t *out, const int8_t *in, int8_t value,
+                                 size_t count);
+using ReluInt8Fn = void (*)(int8_t *out, const int8_t *in, size_t count);
+
+// INT8 GEMV micro-kernel, like GemvTileFn but with exact products accumulated
+// in INT32. All implementations produce identical results.
+using GemvTileInt8Fn = void (*)(int32_t *acc, size_t accStride,
+                                const int8_t *mat, size_t ld,
+                                const int8_t *vec, size_t vecStride,
+                                size_t numVecs, size_t numRows, size_t kc);
+
+// FP32 peak probe: 'iterations' rounds of independent multiply-adds on
+// registers, fused where the ISA has FMA. Returns the number of floating point
+// operations, and stores a result to 'sink' so the work is not optimized away.
+using FmaProbeFn = uint64_t (*)(size_t iterations, float *sink);
+
+struct KernelTable {
+  const char *isa;
+  EltBinaryFn add;
+  EltScalarFn addScalar;
+  EltBinaryFn mul;
+  EltScalarFn mulScalar;
+  GemvTileFn gemvTile;
+  EltBinaryInt8Fn addInt8;
+  EltScalarInt8Fn addScalarInt8;
+  EltBinaryInt8Fn mulInt8;
+  EltScalarInt8Fn mulScalarInt8;
+  GemvTileInt8Fn gemvTileInt8;
+  GemvTileFn gemvTileT;
+  GemvTileInt8Fn gemvTileTInt8;
+  ReluFn relu;
+  BatchNormFn batchNorm;
+  ReluInt8Fn reluInt8;
+  FmaProbeFn fmaProbe;
+};
+
+// Selects the kernels returned by GetKernels, i.e., the kernels of the best
+// ISA supported by the host. If 'maxIsa' names one of the ISA levels
+// "scalar", "avx2", "avx512", "avx512vnni" and "avx512fp16", no kernels of a
+// higher level are selected, so all levels up to the best one of the host can
+// be compared on the same host. Other values, including null, are ignored.
+// Must not be called while kernels are running.
+void SelectKernels(const char *maxIsa);
+
+// Returns the selected kernels, the kernels of the best ISA supported by the
+// host if SelectKernels was never called.
+const KernelTable &GetKernels();
+
+constexpr size_t GEMV_ROW_TILE = 64;
+constexpr size_t GEMV_K_TILE = 2048;
+// Transposed weights are read in wide, short tiles: each of the few rows of a
+// tile covers whole cache lines, and the tile spans few pages.
+constexpr size_t GEMV_T_ROW_TILE = 512;
+constexpr size_t GEMV_T_K_TILE = 64;
+
+// Operations applied to the FP32 or INT32 GEMV result before it is rounded to
+// FP16 or saturated to INT8.
+template <typename T> struct GemvEpilogue {
+  // Values added to the result, with the same layout as the output except for
+  // the distance 'addendStride' between the vectors. May alias the output.
+  const T *addend = nullptr;
+  size_t addendStride = 0;
+  // Applies ReLU after the addition, with the semantics of PimExecuteRelu.
+  bool relu = false;
+};
+
+// Layouts of the GEMV weights.
+enum class GemvLayout {
+  // Row-major, i.e., the layout of GEMV_WEIGHT buffers.
+  ROW_MAJOR,
+  // Column-major, i.e., the layout of GEMV_WEIGHT_T buffers.
+  TRANSPOSED,
+  // The layout created by PackGemvWeights.
+  BLOCKED,
+};
+
+// Blocked layout of GEMV weights, created once by PackGemvWeights. The rows
+// are split into panels of GEMV_ROW_TILE rows and each panel into tiles of
+// GEMV_K_TILE columns, i.e., exactly the tiles processed by Gemv. The tiles
+// are stored one after the other, so Gemv streams the weights sequentially,
+// and the rows of a tile are padded to a whole number of cache lines. The
+// layout of a matrix of 'numRows' rows occupies numRows * BlockedGemvLd(k)
+// elements, with the panel starting at row r at offset r * BlockedGemvLd(k).
+size_t BlockedGemvLd(size_t k, size_t elementSize);
+
+// Copies the 'numRows' x 'k' matrix 'src' into the blocked layout at 'dst'.
+// 'src' is row-major, or column-major if 'transposed' is set, with leading
+// dimension 'srcLd'. The padding is zeroed.
+void PackGemvWeights(void *dst, const void *src, size_t srcLd, size_t numRows,
+                     size_t k, size_t elementSize, bool transposed);
+
+// Batched GEMV of 'numRows' rows of the row-major FP16 matrix 'mat' with
+// leading dimension 'ld' and 'numVecs' FP16 vectors of length 'k':
+// out[v * outStride + r] = sum(mat[r * ld + i] * vec[v * vecStride + i]),
+// accumulated in FP32, passed through 'epilogue' and rounded to FP16 once.
+// The matrix is processed in tiles of GEMV_ROW_TILE rows and GEMV_K_TILE
+// columns, and each tile is applied to all vectors while it is in cache, so
+// the matrix is read from memory once regardless of the number of vectors.
+// For the other layouts, 'ld' is the leading dimension of the column-major
+// matrix, or BlockedGemvLd(k) for the blocked layout, in which case 'mat' must
+// start at a panel. The blocked layout gives results identical to row-major.
+void Gemv(half_t *out, size_t outStride, const half_t *mat, size_t ld,
+          GemvLayout layout, const half_t *vec, size_t vecStride,
+          size_t numVecs, size_t numRows, size_t k,
+          const GemvEpilogue<half_t> &epilogue);
+
+// INT8 version of the batched GEMV, accumulating in INT32. The result of the
+// epilogue is saturated to INT8.
+void Gemv(int8_t *out, size_t outStride, const int8_t *mat, size_t ld,
+          GemvLayout layout, const int8_t *vec, size_t vecStride,
+          size_t numVecs, size_t numRows, size_t k,
+          const GemvEpilogue<int8_t> &epilogue);
+
+// Portable implementation, also used for the tails of the vector kernels.
+namespace scalar {
+void Add(half_t *out, const half_t *in0, const half_t *in1, size_t count);
+void AddScalar(half_t *out, const half_t *in, half_t value, size_t count);
+void Mul(half_t *out, const half_t *in0, const half_t *in1, size_t count);
+void MulScalar(half_t *out, const half_t *in, half_t value, size_t count);
+void Relu(half_t *out, const half_t *in, size_t count);
+void BatchNorm(half_t *out, const half_t *in, half_t mean, half_t divisor,
+               half_t gamma, half_t beta, size_t count);
+void GemvTile(float *acc, size_t accStride, const half_t *mat, size_t ld,
+              const float *vec, size_t vecStride, size_t numVecs,
+              size_t numRows, size_t kc);
+void AddInt8(int8_t *out, const int8_t *in0, const int8_t *in1, size_t count);
+void AddScalarInt8(int8_t *out, const int8_t *in, int8_t value, size_t count);
+void MulInt8(int8_t *out, const int8_t *in0, const int8_t *in1, size_t count);
+void MulScalarInt8(int8_t *out, const int8_t *in, int8_t value, size_t count);
+void ReluInt8(int8_t *out, const int8_t *in, size_t count);
+void GemvTileInt8(int32_t *acc, size_t accStride, const int8_t *mat, size_t ld,
+                  const int8_t *vec, size_t vecStride, size_t numVecs,
+                  size_t numRows, size_t kc);
+void GemvTileT(float *acc, size_t accStride, const half_t *mat, size_t ld,
+               const float *vec, size_t vecStride, size_t numVecs,
+               size_t numRows, size_t kc);
+void GemvTileTInt8(int32_t *acc, size_t accStride, const int8_t *mat,
+                   size_t ld, const int8_t *vec, size_t vecStride,
+                   size_t numVecs, size_t numRows, size_t kc);
+uint64_t FmaProbe(size_t iterations, float *sink);
+} // namespace scalar
+
+#ifdef PIMMOCK_HAVE_AVX2
+// F16C + AVX2, 8 lanes: convert to FP32, compute, round back to FP16. INT8
+// uses 32 lanes.
+namespace avx2 {
+void Add(half_t *out, const half_t *in0, const half_t *in1, size_t count);
+void AddScalar(half_t *out, const half_t *in, half_t value, size_t count);
+void Mul(half_t *out, const half_t *in0, const half_t *in1, size_t count);
+void MulScalar(half_t *out, const half_t *in, half_t value, size_t count);
+void Relu(half_t *out, const half_t *in, size_t count);
+void BatchNorm(half_t *out, const half_t *in, half_t mean, half_t divisor,
+               half_t gamma, half_t beta, size_t count);
+void GemvTile(float *acc, size_t accStride, const half_t *mat, size_t ld,
+              const float *vec, size_t vecStride, size_t numVecs,
+              size_t numRows, size_t kc);
+void AddInt8(int8_t *out, const int8_t *in0, const int8_t *in1, size_t count);
+void AddScalarInt8(int8_t *out, const int8_t *in, int8_t value, size_t count);
+void MulInt8(int8_t *out, const int8_t *in0, const int8_t *in1, size_t count);
+void MulScalarInt8(int8_t *out, const int8_t *in, int8_t value, size_t count);
+void ReluInt8(int8_t *out, const int8_t *in, size_t count);
+void GemvTileInt8(int32_t *acc, size_t accStride, const int8_t *mat, size_t ld,
+                  const int8_t *vec, size_t vecStride, size_t numVecs,
+                  size_t numRows, size_t kc);
+void GemvTileT(float *acc, size_t accStride, const half_t *mat, size_t ld,
+               const float *vec, size_t vecStride, size_t numVecs,
+               size_t numRows, size_t kc);
+void GemvTileTInt8(int32_t *acc, size_t accStride, const int8_t *mat,
+                   size_t ld, const int8_t *vec, size_t vecStride,
+                   size_t numVecs, size_t numRows, size_t kc);
+uint64_t FmaProbe(size_t iterations, float *sink);
+} // namespace avx2
+#endif
+
+#ifdef PIMMOCK_HAVE_AVX512
+// AVX-512F/BW/VL, 16 lanes via FP32 (64 lanes for INT8), with masked tails.
+namespace avx512 {
+void Add(half_t *out, const half_t *in0, const half_t *in1, size_t count);
+void AddScalar(half_t *out, const half_t *in, half_t value, size_t count);
+void Mul(half_t *out, const half_t *in0, const half_t *in1, size_t count);
+void MulScalar(half_t *out, const half_t *in, half_t value, size_t count);
+void Relu(half_t *out, const half_t *in, size_t count);
+void BatchNorm(half_t *out, const half_t *in, half_t mean, half_t divisor,
+               half_t gamma, half_t beta, size_t count);
+void GemvTile(float *acc, size_t accStride, const half_t *mat, size_t ld,
+              const float *vec, size_t vecStride, size_t numVecs,
+              size_t numRows, size_t kc);
+void AddInt8(int8_t *out, const int8_t *in0, const int8_t *in1, size_t count);
+void AddScalarInt8(int8_t *out, const int8_t *in, int8_t value, size_t count);
+void MulInt8(int8_t *out, const int8_t *in0, const int8_t *in1, size_t count);
+void MulScalarInt8(int8_t *out, const int8_t *in, int8_t value, size_t count);
+void ReluInt8(int8_t *out, const int8_t *in, size_t count);
+void GemvTileInt8(int32_t *acc, size_t accStride, const int8_t *mat, size_t ld,
+                  const int8_t *vec, size_t vecStride, size_t numVecs,
+                  size_t numRows, size_t kc);
+void GemvTileT(float *acc, size_t accStride, const half_t *mat, size_t ld,
+               const float *vec, size_t vecStride, size_t numVecs,
+               size_t numRows, size_t kc);
+void GemvTileTInt8(int32_t *acc, size_t accStride, const int8_t *mat,
+                   size_t ld, const int8_t *vec, size_t vecStride,
+                   size_t numVecs, size_t numRows, size_t kc);
+uint64_t FmaProbe(size_t iterations, float *sink);
+} // namespace avx512
+#endif
+
+#ifdef PIMMOCK_HAVE_AVX512VNNI
+// AVX-512-VNNI, INT8 GEMV with VPDPBUSD.
+namespace avx512vnni {
+void GemvTileInt8(int32_t *acc, size_t accStride, const int8_t *mat, size_t ld,
+                  const int8_t *vec, size_t vecStride, size_t numVecs,
+                  size_t numRows, size_t kc);
+} // namespace avx512vnni
+#endif
+
+#ifdef PIMMOCK_HAVE_AVX512FP16
+// AVX-512-FP16, 32 lanes of native FP16 arithmetic. GEMV accumulates in FP32
+// and therefore uses the AVX-512 kernel, as does INT8.
+namespace avx512fp16 {
+void Add(half_t *out, const half_t *in0, const half_t *in1, size_t count);
+void AddScalar(half_t *out, const half_t *in, half_t value, size_t count);
+void Mul(half_t *out, const half_t *in0, const half_t *in1, size_t count);
+void MulScalar(half_t *out, const half_t *in, half_t value, size_t count);
+} // namespace avx512fp16
+#endif
+
+} // namespace kernels
+} // namespace mock
+} // namespace pim
+
+#endif /* _PIM_KERNELS_H_ */
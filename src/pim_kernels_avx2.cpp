@@ -0,0 +1,607 @@
+/*
+ * Copyright (C) 2021 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system, or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+// This file is compiled with '-mavx2 -mf16c -mfma'. It must only contain
+// intrinsics and plain loops, no inline functions or templates shared with
+// other translation units (e.g., from half.hpp), as the linker could otherwise
+// pick the AVX2 version of such a function for use on hosts without AVX2.
+
+#include "pim_kernels.h"
+
+#include <cstdint>
+#include <immintrin.h>
+
+namespace pim {
+namespace mock {
+namespace kernels {
+namespace avx2 {
+
+namespace {
+
+// FP16 -> FP32 -> FP16 is exact for a single add or mul, as FP32 has more than
+// 2 * 11 + 2 bits of mantissa, so rounding the FP32 result to FP16 yields the
+// correctly rounded FP16 result. Only the NaN payloads differ from half.hpp, so
+// vectors producing a NaN are recomputed by the scalar kernel.
+constexpr int ROUNDING = _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC;
+constexpr size_t LANES = 8;
+
+inline __m256 Load(const half_t *ptr) {
+  return _mm256_cvtph_ps(
+      _mm_loadu_si128(reinterpret_cast<const __m128i *>(ptr)));
+}
+
+inline void Store(half_t *ptr, __m256 value) {
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(ptr),
+                   _mm256_cvtps_ph(value, ROUNDING));
+}
+
+inline bool HasNaN(__m256 value) {
+  return _mm256_movemask_ps(_mm256_cmp_ps(value, value, _CMP_UNORD_Q)) != 0;
+}
+
+inline __m256 Broadcast(const half_t &value) {
+  uint16_t bits;
+  __builtin_memcpy(&bits, &value, sizeof(bits));
+  return _mm256_cvtph_ps(_mm_set1_epi16(static_cast<short>(bits)));
+}
+
+// Stores 'op(i)' for all full vectors, 'fallback(i, n)' computes the tail and
+// the vectors containing NaNs.
+template <typename Op, typename Fallback>
+inline void Apply(half_t *out, size_t count, Op op, Fallback fallback) {
+  size_t i = 0;
+  for (; i + LANES <= count; i += LANES) {
+    __m256 result = op(i);
+    if (HasNaN(result)) {
+      fallback(i, LANES);
+      continue;
+    }
+    Store(out + i, result);
+  }
+  fallback(i, count - i);
+}
+
+// Rounds every lane to FP16, for kernels chaining several FP16 operations.
+inline __m256 Round(__m256 value) {
+  return _mm256_cvtph_ps(_mm256_cvtps_ph(value, ROUNDING));
+}
+
+inline float ToFloat(const half_t &value) {
+  uint16_t bits;
+  __builtin_memcpy(&bits, &value, sizeof(bits));
+  return _cvtsh_ss(bits);
+}
+
+inline float HorizontalSum(__m256 value) {
+  __m128 sum = _mm_add_ps(_mm256_castps256_ps128(value),
+                          _mm256_extractf128_ps(value, 1));
+  sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+  sum = _mm_add_ss(sum, _mm_movehdup_ps(sum));
+  return _mm_cvtss_f32(sum);
+}
+
+// Computes ROWS rows times VECS vectors of a GEMV tile, loading each matrix
+// element once for all vectors. Two accumulators per row and vector hide the
+// FMA latency. The summation order does not depend on ROWS or VECS, so every
+// output is independent of how the rows and vectors are blocked.
+template <size_t ROWS, size_t VECS>
+inline void GemvBlock(float *acc, size_t accStride, const half_t *mat,
+                      size_t ld, const float *vec, size_t vecStride,
+                      size_t kc) {
+  __m256 sum0[ROWS][VECS];
+  __m256 sum1[ROWS][VECS];
+#pragma GCC unroll 4
+  for (size_t r = 0; r < ROWS; ++r) {
+#pragma GCC unroll 4
+    for (size_t v = 0; v < VECS; ++v) {
+      sum0[r][v] = _mm256_setzero_ps();
+      sum1[r][v] = _mm256_setzero_ps();
+    }
+  }
+  size_t i = 0;
+  for (; i + 2 * LANES <= kc; i += 2 * LANES) {
+#pragma GCC unroll 4
+    for (size_t r = 0; r < ROWS; ++r) {
+      __m256 m0 = Load(mat + r * ld + i);
+      __m256 m1 = Load(mat + r * ld + i + LANES);
+#pragma GCC unroll 4
+      for (size_t v = 0; v < VECS; ++v) {
+        const float *x = vec + v * vecStride + i;
+        sum0[r][v] = _mm256_fmadd_ps(m0, _mm256_loadu_ps(x), sum0[r][v]);
+        sum1[r][v] =
+            _mm256_fmadd_ps(m1, _mm256_loadu_ps(x + LANES), sum1[r][v]);
+      }
+    }
+  }
+  for (; i + LANES <= kc; i += LANES) {
+#pragma GCC unroll 4
+    for (size_t r = 0; r < ROWS; ++r) {
+      __m256 m0 = Load(mat + r * ld + i);
+#pragma GCC unroll 4
+      for (size_t v = 0; v < VECS; ++v) {
+        const float *x = vec + v * vecStride + i;
+        sum0[r][v] = _mm256_fmadd_ps(m0, _mm256_loadu_ps(x), sum0[r][v]);
+      }
+    }
+  }
+#pragma GCC unroll 4
+  for (size_t r = 0; r < ROWS; ++r) {
+#pragma GCC unroll 4
+    for (size_t v = 0; v < VECS; ++v) {
+      const float *x = vec + v * vecStride;
+      float sum = HorizontalSum(_mm256_add_ps(sum0[r][v], sum1[r][v]));
+      for (size_t j = i; j < kc; ++j) {
+        sum += ToFloat(mat[r * ld + j]) * x[j];
+      }
+      acc[v * accStride + r] += sum;
+    }
+  }
+}
+
+// INT8 arithmetic is exact, so the vector kernels only need to saturate like
+// the scalar kernels.
+constexpr size_t INT8_LANES = 32;
+
+inline __m256i LoadInt8(const int8_t *ptr) {
+  return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(ptr));
+}
+
+inline void StoreInt8(int8_t *ptr, __m256i value) {
+  _mm256_storeu_si256(reinterpret_cast<__m256i *>(ptr), value);
+}
+
+// Saturating multiplication of 32 INT8 lanes via INT16.
+inline __m256i MulSaturateInt8(__m256i a, __m256i b) {
+  __m256i lo = _mm256_mullo_epi16(
+      _mm256_cvtepi8_epi16(_mm256_castsi256_si128(a)),
+      _mm256_cvtepi8_epi16(_mm256_castsi256_si128(b)));
+  __m256i hi = _mm256_mullo_epi16(
+      _mm256_cvtepi8_epi16(_mm256_extracti128_si256(a, 1)),
+      _mm256_cvtepi8_epi16(_mm256_extracti128_si256(b, 1)));
+  // The pack works within 128-bit lanes, the permutation restores the order.
+  return _mm256_permute4x64_epi64(_mm256_packs_epi16(lo, hi), 0xD8);
+}
+
+// Stores 'op(i)' for all full vectors, 'fallback(i, n)' computes the tail.
+template <typename Op, typename Fallback>
+inline void ApplyInt8(int8_t *out, size_t count, Op op, Fallback fallback) {
+  size_t i = 0;
+  for (; i + INT8_LANES <= count; i += INT8_LANES) {
+    StoreInt8(out + i, op(i));
+  }
+  fallback(i, count - i);
+}
+
+inline int32_t HorizontalSumInt32(__m256i value) {
+  __m128i sum = _mm_add_epi32(_mm256_castsi256_si128(value),
+                              _mm256_extracti128_si256(value, 1));
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+  return _mm_cvtsi128_si32(sum);
+}
+
+// INT8 version of GemvBlock: 16 elements per step are sign-extended to INT16
+// and multiplied and pairwise added to INT32 with VPMADDWD.
+template <size_t ROWS, size_t VECS>
+inline void GemvBlockInt8(int32_t *acc, size_t accStride, const int8_t *mat,
+                          size_t ld, const int8_t *vec, size_t vecStride,
+                          size_t kc) {
+  constexpr size_t STEP = 16;
+  __m256i sum[ROWS][VECS];
+#pragma GCC unroll 4
+  for (size_t r = 0; r < ROWS; ++r) {
+#pragma GCC unroll 4
+    for (size_t v = 0; v < VECS; ++v) {
+      sum[r][v] = _mm256_setzero_si256();
+    }
+  }
+  size_t i = 0;
+  for (; i + STEP <= kc; i += STEP) {
+    __m256i x[VECS];
+#pragma GCC unroll 4
+    for (size_t v = 0; v < VECS; ++v) {
+      x[v] = _mm256_cvtepi8_epi16(_mm_loadu_si128(
+          reinterpret_cast<const __m128i *>(vec + v * vecStride + i)));
+    }
+#pragma GCC unroll 4
+    for (size_t r = 0; r < ROWS; ++r) {
+      __m256i m = _mm256_cvtepi8_epi16(_mm_loadu_si128(
+          reinterpret_cast<const __m128i *>(mat + r * ld + i)));
+#pragma GCC unroll 4
+      for (size_t v = 0; v < VECS; ++v) {
+        sum[r][v] = _mm256_add_epi32(sum[r][v], _mm256_madd_epi16(m, x[v]));
+      }
+    }
+  }
+  for (size_t r = 0; r < ROWS; ++r) {
+    for (size_t v = 0; v < VECS; ++v) {
+      const int8_t *x = vec + v * vecStride;
+      int32_t total = HorizontalSumInt32(sum[r][v]);
+      for (size_t j = i; j < kc; ++j) {
+        total += int32_t{mat[r * ld + j]} * x[j];
+      }
+      acc[v * accStride + r] += total;
+    }
+  }
+}
+
+// Transposed GEMV block of COLS x LANES consecutive rows, i.e., consecutive
+// elements of the column-major matrix, times VECS vectors. Every step
+// multiplies one element of each vector with a unit-stride load of the matrix.
+// The even and odd columns are summed by separate accumulators to hide the FMA
+// latency, which makes every output independent of the blocking as well.
+template <size_t COLS, size_t VECS>
+inline void GemvBlockT(float *acc, size_t accStride, const half_t *mat,
+                       size_t ld, const float *vec, size_t vecStride,
+                       size_t kc) {
+  __m256 sum0[COLS][VECS];
+  __m256 sum1[COLS][VECS];
+#pragma GCC unroll 4
+  for (size_t c = 0; c < COLS; ++c) {
+#pragma GCC unroll 4
+    for (size_t v = 0; v < VECS; ++v) {
+      sum0[c][v] = _mm256_setzero_ps();
+      sum1[c][v] = _mm256_setzero_ps();
+    }
+  }
+  size_t i = 0;
+  for (; i + 2 <= kc; i += 2) {
+#pragma GCC unroll 4
+    for (size_t c = 0; c < COLS; ++c) {
+      __m256 m0 = Load(mat + i * ld + c * LANES);
+      __m256 m1 = Load(mat + (i + 1) * ld + c * LANES);
+#pragma GCC unroll 4
+      for (size_t v = 0; v < VECS; ++v) {
+        const float *x = vec + v * vecStride + i;
+        sum0[c][v] = _mm256_fmadd_ps(m0, _mm256_broadcast_ss(x), sum0[c][v]);
+        sum1[c][v] =
+            _mm256_fmadd_ps(m1, _mm256_broadcast_ss(x + 1), sum1[c][v]);
+      }
+    }
+  }
+  if (i < kc) {
+#pragma GCC unroll 4
+    for (size_t c = 0; c < COLS; ++c) {
+      __m256 m0 = Load(mat + i * ld + c * LANES);
+#pragma GCC unroll 4
+      for (size_t v = 0; v < VECS; ++v) {
+        const float *x = vec + v * vecStride + i;
+        sum0[c][v] = _mm256_fmadd_ps(m0, _mm256_broadcast_ss(x), sum0[c][v]);
+      }
+    }
+  }
+#pragma GCC unroll 4
+  for (size_t c = 0; c < COLS; ++c) {
+#pragma GCC unroll 4
+    for (size_t v = 0; v < VECS; ++v) {
+      float *a = acc + v * accStride + c * LANES;
+      _mm256_storeu_ps(a, _mm256_add_ps(_mm256_loadu_ps(a),
+                                        _mm256_add_ps(sum0[c][v], sum1[c][v])));
+    }
+  }
+}
+
+// INT8 version of GemvBlockT for COLS x 16 rows. Two columns of the matrix
+// are interleaved and sign-extended to INT16, so that VPMADDWD with a pair of
+// vector elements computes two products per row at once.
+template <size_t COLS, size_t VECS>
+inline void GemvBlockTInt8(int32_t *acc, size_t accStride, const int8_t *mat,
+                           size_t ld, const int8_t *vec, size_t vecStride,
+                           size_t kc) {
+  constexpr size_t STEP = 16;
+  // Rows [0, 8) and [8, 16) of every 16 rows.
+  __m256i lo[COLS][VECS];
+  __m256i hi[COLS][VECS];
+#pragma GCC unroll 4
+  for (size_t c = 0; c < COLS; ++c) {
+#pragma GCC unroll 4
+    for (size_t v = 0; v < VECS; ++v) {
+      lo[c][v] = _mm256_setzero_si256();
+      hi[c][v] = _mm256_setzero_si256();
+    }
+  }
+  for (size_t i = 0; i < kc; i += 2) {
+    // An odd last column is paired with zeros.
+    bool pair = i + 1 < kc;
+    __m256i x[VECS];
+#pragma GCC unroll 4
+    for (size_t v = 0; v < VECS; ++v) {
+      const int8_t *xv = vec + v * vecStride + i;
+      int32_t next = pair ? xv[1] : 0;
+      x[v] = _mm256_set1_epi32(static_cast<int32_t>(
+          static_cast<uint16_t>(xv[0]) | (static_cast<uint32_t>(next) << 16)));
+    }
+#pragma GCC unroll 4
+    for (size_t c = 0; c < COLS; ++c) {
+      __m128i m0 = _mm_loadu_si128(
+          reinterpret_cast<const __m128i *>(mat + i * ld + c * STEP));
+      __m128i m1 = pair ? _mm_loadu_si128(reinterpret_cast<const __m128i *>(
+                              mat + (i + 1) * ld + c * STEP))
+                        : _mm_setzero_si128();
+      __m256i mlo = _mm256_cvtepi8_epi16(_mm_unpacklo_epi8(m0, m1));
+      __m256i mhi = _mm256_cvtepi8_epi16(_mm_unpackhi_epi8(m0, m1));
+#pragma GCC unroll 4
+      for (size_t v = 0; v < VECS; ++v) {
+        lo[c][v] = _mm256_add_epi32(lo[c][v], _mm256_madd_epi16(mlo, x[v]));
+        hi[c][v] = _mm256_add_epi32(hi[c][v], _mm256_madd_epi16(mhi, x[v]));
+      }
+    }
+  }
+#pragma GCC unroll 4
+  for (size_t c = 0; c < COLS; ++c) {
+#pragma GCC unroll 4
+    for (size_t v = 0; v < VECS; ++v) {
+      auto *a = reinterpret_cast<__m256i *>(acc + v * accStride + c * STEP);
+      _mm256_storeu_si256(
+          a, _mm256_add_epi32(_mm256_loadu_si256(a), lo[c][v]));
+      _mm256_storeu_si256(
+          a + 1, _mm256_add_epi32(_mm256_loadu_si256(a + 1), hi[c][v]));
+    }
+  }
+}
+
+template <size_t N> struct Size {
+  static constexpr size_t value = N;
+};
+
+// Calls 'block(Size<R>(), Size<V>(), r, v)' for blocks of R rows and V vectors
+// starting at row r and vector v, covering the tile with ROWS x VECS blocks and
+// the remaining rows and vectors with smaller blocks. The vectors are the outer
+// loop, so that the tiles of VECS vectors stay in L1 while the matrix tile is
+// streamed from L2.
+template <size_t ROWS, size_t VECS, typename Block>
+inline void ForEachBlock(size_t numVecs, size_t numRows, Block block) {
+  size_t v = 0;
+  for (; v + VECS <= numVecs; v += VECS) {
+    size_t r = 0;
+    for (; r + ROWS <= numRows; r += ROWS) {
+      block(Size<ROWS>(), Size<VECS>(), r, v);
+    }
+    for (; r < numRows; ++r) {
+      block(Size<1>(), Size<VECS>(), r, v);
+    }
+  }
+  for (; v < numVecs; ++v) {
+    size_t r = 0;
+    for (; r + ROWS <= numRows; r += ROWS) {
+      block(Size<ROWS>(), Size<1>(), r, v);
+    }
+    for (; r < numRows; ++r) {
+      block(Size<1>(), Size<1>(), r, v);
+    }
+  }
+}
+
+} // anonymous namespace
+
+void Add(half_t *out, const half_t *in0, const half_t *in1, size_t count) {
+  Apply(
+      out, count,
+      [=](size_t i) { return _mm256_add_ps(Load(in0 + i), Load(in1 + i)); },
+      [=](size_t i, size_t n) { scalar::Add(out + i, in0 + i, in1 + i, n); });
+}
+
+void AddScalar(half_t *out, const half_t *in, half_t value, size_t count) {
+  __m256 s = Broadcast(value);
+  Apply(
+      out, count, [=](size_t i) { return _mm256_add_ps(Load(in + i), s); },
+      [=](size_t i, size_t n) {
+        scalar::AddScalar(out + i, in + i, value, n);
+      });
+}
+
+void Mul(half_t *out, const half_t *in0, const half_t *in1, size_t count) {
+  Apply(
+      out, count,
+      [=](size_t i) { return _mm256_mul_ps(Load(in0 + i), Load(in1 + i)); },
+      [=](size_t i, size_t n) { scalar::Mul(out + i, in0 + i, in1 + i, n); });
+}
+
+void MulScalar(half_t *out, const half_t *in, half_t value, size_t count) {
+  __m256 s = Broadcast(value);
+  Apply(
+      out, count, [=](size_t i) { return _mm256_mul_ps(Load(in + i), s); },
+      [=](size_t i, size_t n) {
+        scalar::MulScalar(out + i, in + i, value, n);
+      });
+}
+
+void Relu(half_t *out, const half_t *in, size_t count) {
+  // ReLU selects either the input or +0, so it works on the bits. The scalar
+  // kernel quiets signaling NaNs, so vectors containing NaNs are recomputed
+  // by it.
+  constexpr size_t STEP = 16;
+  const __m256i magnitude = _mm256_set1_epi16(0x7FFF);
+  const __m256i infinity = _mm256_set1_epi16(0x7C00);
+  size_t i = 0;
+  for (; i + STEP <= count; i += STEP) {
+    __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + i));
+    __m256i nan =
+        _mm256_cmpgt_epi16(_mm256_and_si256(x, magnitude), infinity);
+    if (!_mm256_testz_si256(nan, nan)) {
+      scalar::Relu(out + i, in + i, STEP);
+      continue;
+    }
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i),
+                        _mm256_andnot_si256(_mm256_srai_epi16(x, 15), x));
+  }
+  scalar::Relu(out + i, in + i, count - i);
+}
+
+void BatchNorm(half_t *out, const half_t *in, half_t mean, half_t divisor,
+               half_t gamma, half_t beta, size_t count) {
+  // Rounding every intermediate result to FP16 gives the result of each
+  // half_t operation of the scalar kernel.
+  __m256 m = Broadcast(mean);
+  __m256 d = Broadcast(divisor);
+  __m256 g = Broadcast(gamma);
+  __m256 b = Broadcast(beta);
+  Apply(
+      out, count,
+      [=](size_t i) {
+        __m256 norm =
+            Round(_mm256_div_ps(Round(_mm256_sub_ps(Load(in + i), m)), d));
+        return _mm256_add_ps(Round(_mm256_mul_ps(g, norm)), b);
+      },
+      [=](size_t i, size_t n) {
+        scalar::BatchNorm(out + i, in + i, mean, divisor, gamma, beta, n);
+      });
+}
+
+void GemvTile(float *acc, size_t accStride, const half_t *mat, size_t ld,
+              const float *vec, size_t vecStride, size_t numVecs,
+              size_t numRows, size_t kc) {
+  auto block = [=](auto rows, auto vecs, size_t r, size_t v) {
+    GemvBlock<decltype(rows)::value, decltype(vecs)::value>(
+        acc + v * accStride + r, accStride, mat + r * ld, ld,
+        vec + v * vecStride, vecStride, kc);
+  };
+  // Both block shapes use 8 accumulators, which with the operands fit into the
+  // 16 ymm registers.
+  if (numVecs == 1) {
+    ForEachBlock<4, 1>(numVecs, numRows, block);
+  } else {
+    ForEachBlock<2, 2>(numVecs, numRows, block);
+  }
+}
+
+void AddInt8(int8_t *out, const int8_t *in0, const int8_t *in1, size_t count) {
+  ApplyInt8(
+      out, count,
+      [=](size_t i) {
+        return _mm256_adds_epi8(LoadInt8(in0 + i), LoadInt8(in1 + i));
+      },
+      [=](size_t i, size_t n) {
+        scalar::AddInt8(out + i, in0 + i, in1 + i, n);
+      });
+}
+
+void AddScalarInt8(int8_t *out, const int8_t *in, int8_t value, size_t count) {
+  __m256i s = _mm256_set1_epi8(value);
+  ApplyInt8(
+      out, count,
+      [=](size_t i) { return _mm256_adds_epi8(LoadInt8(in + i), s); },
+      [=](size_t i, size_t n) {
+        scalar::AddScalarInt8(out + i, in + i, value, n);
+      });
+}
+
+void MulInt8(int8_t *out, const int8_t *in0, const int8_t *in1, size_t count) {
+  ApplyInt8(
+      out, count,
+      [=](size_t i) {
+        return MulSaturateInt8(LoadInt8(in0 + i), LoadInt8(in1 + i));
+      },
+      [=](size_t i, size_t n) {
+        scalar::MulInt8(out + i, in0 + i, in1 + i, n);
+      });
+}
+
+void MulScalarInt8(int8_t *out, const int8_t *in, int8_t value, size_t count) {
+  __m256i s = _mm256_set1_epi8(value);
+  ApplyInt8(
+      out, count,
+      [=](size_t i) { return MulSaturateInt8(LoadInt8(in + i), s); },
+      [=](size_t i, size_t n) {
+        scalar::MulScalarInt8(out + i, in + i, value, n);
+      });
+}
+
+void ReluInt8(int8_t *out, const int8_t *in, size_t count) {
+  __m256i zero = _mm256_setzero_si256();
+  ApplyInt8(
+      out, count,
+      [=](size_t i) { return _mm256_max_epi8(LoadInt8(in + i), zero); },
+      [=](size_t i, size_t n) { scalar::ReluInt8(out + i, in + i, n); });
+}
+
+void GemvTileInt8(int32_t *acc, size_t accStride, const int8_t *mat, size_t ld,
+                  const int8_t *vec, size_t vecStride, size_t numVecs,
+                  size_t numRows, size_t kc) {
+  auto block = [=](auto rows, auto vecs, size_t r, size_t v) {
+    GemvBlockInt8<decltype(rows)::value, decltype(vecs)::value>(
+        acc + v * accStride + r, accStride, mat + r * ld, ld,
+        vec + v * vecStride, vecStride, kc);
+  };
+  if (numVecs == 1) {
+    ForEachBlock<4, 1>(numVecs, numRows, block);
+  } else {
+    ForEachBlock<4, 2>(numVecs, numRows, block);
+  }
+}
+
+void GemvTileT(float *acc, size_t accStride, const half_t *mat, size_t ld,
+               const float *vec, size_t vecStride, size_t numVecs,
+               size_t numRows, size_t kc) {
+  // Blocks of COLS x LANES rows, i.e., ForEachBlock counts groups of LANES
+  // rows. The remaining rows are computed by the scalar kernel. Both block
+  // shapes use 8 accumulators.
+  auto block = [=](auto cols, auto vecs, size_t c, size_t v) {
+    GemvBlockT<decltype(cols)::value, decltype(vecs)::value>(
+        acc + v * accStride + c * LANES, accStride, mat + c * LANES, ld,
+        vec + v * vecStride, vecStride, kc);
+  };
+  size_t vectorRows = numRows / LANES * LANES;
+  if (numVecs == 1) {
+    ForEachBlock<4, 1>(numVecs, vectorRows / LANES, block);
+  } else {
+    ForEachBlock<2, 2>(numVecs, vectorRows / LANES, block);
+  }
+  scalar::GemvTileT(acc + vectorRows, accStride, mat + vectorRows, ld, vec,
+                    vecStride, numVecs, numRows - vectorRows, kc);
+}
+
+void GemvTileTInt8(int32_t *acc, size_t accStride, const int8_t *mat,
+                   size_t ld, const int8_t *vec, size_t vecStride,
+                   size_t numVecs, size_t numRows, size_t kc) {
+  constexpr size_t STEP = 16;
+  auto block = [=](auto cols, auto vecs, size_t c, size_t v) {
+    GemvBlockTInt8<decltype(cols)::value, decltype(vecs)::value>(
+        acc + v * accStride + c * STEP, accStride, mat + c * STEP, ld,
+        vec + v * vecStride, vecStride, kc);
+  };
+  size_t vectorRows = numRows / STEP * STEP;
+  if (numVecs == 1) {
+    ForEachBlock<4, 1>(numVecs, vectorRows / STEP, block);
+  } else {
+    ForEachBlock<2, 2>(numVecs, vectorRows / STEP, block);
+  }
+  scalar::GemvTileTInt8(acc + vectorRows, accStride, mat + vectorRows, ld, vec,
+                        vecStride, numVecs, numRows - vectorRows, kc);
+}
+
+uint64_t FmaProbe(size_t iterations, float *sink) {
+  // Enough independent chains to cover the latency of two FMA ports.
+  constexpr size_t CHAINS = 12;
+  const __m256 factor = _mm256_set1_ps(0.999999f);
+  const __m256 addend = _mm256_set1_ps(1e-7f);
+  __m256 acc[CHAINS];
+  for (size_t c = 0; c < CHAINS; ++c) {
+    acc[c] = _mm256_set1_ps(static_cast<float>(c));
+  }
+  for (size_t i = 0; i < iterations; ++i) {
+    for (size_t c = 0; c < CHAINS; ++c) {
+      acc[c] = _mm256_fmadd_ps(acc[c], factor, addend);
+    }
+  }
+  for (size_t c = 1; c < CHAINS; ++c) {
+    acc[0] = _mm256_add_ps(acc[0], acc[c]);
+  }
+  float lanes[LANES];
+  _mm256_storeu_ps(lanes, acc[0]);
+  *sink = lanes[0];
+  return uint64_t{2} * LANES * CHAINS * iterations;
+}
+
+} // namespace avx2
+} // namespace kernels
+} // namespace mock
+} // namespace pim
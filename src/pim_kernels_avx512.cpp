@@ -0,0 +1,581 @@
+/*
+ * Copyright (C) 2021 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system, or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+// This file is compiled with '-mavx512f -mavx512bw -mavx512vl'. See
+// pim_kernels_avx2.cpp for the restrictions on code in this file.
+
+#include "pim_kernels.h"
+
+#include <cstdint>
+#include <immintrin.h>
+
+namespace pim {
+namespace mock {
+namespace kernels {
+namespace avx512 {
+
+namespace {
+
+// See pim_kernels_avx2.cpp on why converting to FP32 gives bit-identical
+// results and why vectors producing NaNs are recomputed by the scalar kernel.
+constexpr int ROUNDING = _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC;
+constexpr size_t LANES = 16;
+constexpr __mmask16 FULL = 0xFFFF;
+
+inline __m512 Load(const half_t *ptr, __mmask16 mask) {
+  return _mm512_cvtph_ps(_mm256_maskz_loadu_epi16(mask, ptr));
+}
+
+inline void Store(half_t *ptr, __m512 value, __mmask16 mask) {
+  _mm256_mask_storeu_epi16(ptr, mask, _mm512_cvtps_ph(value, ROUNDING));
+}
+
+// Rounds every lane to FP16, for kernels chaining several FP16 operations.
+inline __m512 Round(__m512 value) {
+  return _mm512_cvtph_ps(_mm512_cvtps_ph(value, ROUNDING));
+}
+
+inline __m512 Broadcast(const half_t &value) {
+  uint16_t bits;
+  __builtin_memcpy(&bits, &value, sizeof(bits));
+  return _mm512_cvtph_ps(_mm256_set1_epi16(static_cast<short>(bits)));
+}
+
+// Stores 'op(i, mask)' for all vectors including the masked tail,
+// 'fallback(i, n)' recomputes the vectors containing NaNs.
+template <typename Op, typename Fallback>
+inline void Apply(half_t *out, size_t count, Op op, Fallback fallback) {
+  for (size_t i = 0; i < count; i += LANES) {
+    size_t n = (count - i < LANES) ? count - i : LANES;
+    __mmask16 mask =
+        (n == LANES) ? FULL : static_cast<__mmask16>((1u << n) - 1u);
+    __m512 result = op(i, mask);
+    if (_mm512_mask_cmp_ps_mask(mask, result, result, _CMP_UNORD_Q)) {
+      fallback(i, n);
+      continue;
+    }
+    Store(out + i, result, mask);
+  }
+}
+
+// Computes ROWS rows times VECS vectors of a GEMV tile with a masked tail,
+// see pim_kernels_avx2.cpp.
+template <size_t ROWS, size_t VECS>
+inline void GemvBlock(float *acc, size_t accStride, const half_t *mat,
+                      size_t ld, const float *vec, size_t vecStride,
+                      size_t kc) {
+  __m512 sum0[ROWS][VECS];
+  __m512 sum1[ROWS][VECS];
+#pragma GCC unroll 4
+  for (size_t r = 0; r < ROWS; ++r) {
+#pragma GCC unroll 4
+    for (size_t v = 0; v < VECS; ++v) {
+      sum0[r][v] = _mm512_setzero_ps();
+      sum1[r][v] = _mm512_setzero_ps();
+    }
+  }
+  size_t i = 0;
+  for (; i + 2 * LANES <= kc; i += 2 * LANES) {
+#pragma GCC unroll 4
+    for (size_t r = 0; r < ROWS; ++r) {
+      __m512 m0 = Load(mat + r * ld + i, FULL);
+      __m512 m1 = Load(mat + r * ld + i + LANES, FULL);
+#pragma GCC unroll 4
+      for (size_t v = 0; v < VECS; ++v) {
+        const float *x = vec + v * vecStride + i;
+        sum0[r][v] = _mm512_fmadd_ps(m0, _mm512_loadu_ps(x), sum0[r][v]);
+        sum1[r][v] =
+            _mm512_fmadd_ps(m1, _mm512_loadu_ps(x + LANES), sum1[r][v]);
+      }
+    }
+  }
+  for (; i < kc; i += LANES) {
+    size_t n = (kc - i < LANES) ? kc - i : LANES;
+    __mmask16 mask =
+        (n == LANES) ? FULL : static_cast<__mmask16>((1u << n) - 1u);
+#pragma GCC unroll 4
+    for (size_t r = 0; r < ROWS; ++r) {
+      __m512 m0 = Load(mat + r * ld + i, mask);
+#pragma GCC unroll 4
+      for (size_t v = 0; v < VECS; ++v) {
+        const float *x = vec + v * vecStride + i;
+        sum0[r][v] =
+            _mm512_fmadd_ps(m0, _mm512_maskz_loadu_ps(mask, x), sum0[r][v]);
+      }
+    }
+  }
+#pragma GCC unroll 4
+  for (size_t r = 0; r < ROWS; ++r) {
+#pragma GCC unroll 4
+    for (size_t v = 0; v < VECS; ++v) {
+      acc[v * accStride + r] +=
+          _mm512_reduce_add_ps(_mm512_add_ps(sum0[r][v], sum1[r][v]));
+    }
+  }
+}
+
+inline __mmask16 TailMask(size_t n) {
+  return (n >= LANES) ? FULL : static_cast<__mmask16>((1u << n) - 1u);
+}
+
+// Transposed GEMV block of COLS x LANES rows times VECS vectors, see
+// pim_kernels_avx2.cpp. The loads and stores of the last LANES rows use
+// 'lastMask'.
+template <size_t COLS, size_t VECS>
+inline void GemvBlockT(float *acc, size_t accStride, const half_t *mat,
+                       size_t ld, const float *vec, size_t vecStride,
+                       size_t kc, __mmask16 lastMask) {
+  __m512 sum0[COLS][VECS];
+  __m512 sum1[COLS][VECS];
+#pragma GCC unroll 4
+  for (size_t c = 0; c < COLS; ++c) {
+#pragma GCC unroll 4
+    for (size_t v = 0; v < VECS; ++v) {
+      sum0[c][v] = _mm512_setzero_ps();
+      sum1[c][v] = _mm512_setzero_ps();
+    }
+  }
+  size_t i = 0;
+  for (; i + 2 <= kc; i += 2) {
+#pragma GCC unroll 4
+    for (size_t c = 0; c < COLS; ++c) {
+      __mmask16 mask = (c + 1 == COLS) ? lastMask : FULL;
+      __m512 m0 = Load(mat + i * ld + c * LANES, mask);
+      __m512 m1 = Load(mat + (i + 1) * ld + c * LANES, mask);
+#pragma GCC unroll 4
+      for (size_t v = 0; v < VECS; ++v) {
+        const float *x = vec + v * vecStride + i;
+        sum0[c][v] = _mm512_fmadd_ps(m0, _mm512_set1_ps(x[0]), sum0[c][v]);
+        sum1[c][v] = _mm512_fmadd_ps(m1, _mm512_set1_ps(x[1]), sum1[c][v]);
+      }
+    }
+  }
+  if (i < kc) {
+#pragma GCC unroll 4
+    for (size_t c = 0; c < COLS; ++c) {
+      __mmask16 mask = (c + 1 == COLS) ? lastMask : FULL;
+      __m512 m0 = Load(mat + i * ld + c * LANES, mask);
+#pragma GCC unroll 4
+      for (size_t v = 0; v < VECS; ++v) {
+        const float *x = vec + v * vecStride + i;
+        sum0[c][v] = _mm512_fmadd_ps(m0, _mm512_set1_ps(x[0]), sum0[c][v]);
+      }
+    }
+  }
+#pragma GCC unroll 4
+  for (size_t c = 0; c < COLS; ++c) {
+    __mmask16 mask = (c + 1 == COLS) ? lastMask : FULL;
+#pragma GCC unroll 4
+    for (size_t v = 0; v < VECS; ++v) {
+      float *a = acc + v * accStride + c * LANES;
+      _mm512_mask_storeu_ps(
+          a, mask,
+          _mm512_add_ps(_mm512_maskz_loadu_ps(mask, a),
+                        _mm512_add_ps(sum0[c][v], sum1[c][v])));
+    }
+  }
+}
+
+// INT8 kernels, see pim_kernels_avx2.cpp.
+constexpr size_t INT8_LANES = 64;
+constexpr __mmask64 INT8_FULL = ~__mmask64{0};
+
+inline __mmask64 TailMaskInt8(size_t n) {
+  return (n == INT8_LANES) ? INT8_FULL : (__mmask64{1} << n) - 1;
+}
+
+// Saturating multiplication of 64 INT8 lanes via INT16.
+inline __m512i MulSaturateInt8(__m512i a, __m512i b) {
+  __m512i lo = _mm512_mullo_epi16(
+      _mm512_cvtepi8_epi16(_mm512_castsi512_si256(a)),
+      _mm512_cvtepi8_epi16(_mm512_castsi512_si256(b)));
+  __m512i hi = _mm512_mullo_epi16(
+      _mm512_cvtepi8_epi16(_mm512_extracti64x4_epi64(a, 1)),
+      _mm512_cvtepi8_epi16(_mm512_extracti64x4_epi64(b, 1)));
+  // The pack works within 128-bit lanes, the permutation restores the order.
+  return _mm512_permutexvar_epi64(_mm512_setr_epi64(0, 2, 4, 6, 1, 3, 5, 7),
+                                  _mm512_packs_epi16(lo, hi));
+}
+
+// Stores 'op(i, mask)' for all vectors including the masked tail.
+template <typename Op>
+inline void ApplyInt8(int8_t *out, size_t count, Op op) {
+  for (size_t i = 0; i < count; i += INT8_LANES) {
+    size_t n = (count - i < INT8_LANES) ? count - i : INT8_LANES;
+    __mmask64 mask = TailMaskInt8(n);
+    _mm512_mask_storeu_epi8(out + i, mask, op(i, mask));
+  }
+}
+
+// INT8 version of GemvBlock: 32 elements per step are sign-extended to INT16
+// and multiplied and pairwise added to INT32 with VPMADDWD.
+template <size_t ROWS, size_t VECS>
+inline void GemvBlockInt8(int32_t *acc, size_t accStride, const int8_t *mat,
+                          size_t ld, const int8_t *vec, size_t vecStride,
+                          size_t kc) {
+  constexpr size_t STEP = 32;
+  __m512i sum[ROWS][VECS];
+#pragma GCC unroll 4
+  for (size_t r = 0; r < ROWS; ++r) {
+#pragma GCC unroll 4
+    for (size_t v = 0; v < VECS; ++v) {
+      sum[r][v] = _mm512_setzero_si512();
+    }
+  }
+  for (size_t i = 0; i < kc; i += STEP) {
+    size_t n = (kc - i < STEP) ? kc - i : STEP;
+    __mmask32 mask = (n == STEP) ? ~__mmask32{0} : (__mmask32{1} << n) - 1;
+    __m512i x[VECS];
+#pragma GCC unroll 4
+    for (size_t v = 0; v < VECS; ++v) {
+      x[v] = _mm512_cvtepi8_epi16(
+          _mm256_maskz_loadu_epi8(mask, vec + v * vecStride + i));
+    }
+#pragma GCC unroll 4
+    for (size_t r = 0; r < ROWS; ++r) {
+      __m512i m =
+          _mm512_cvtepi8_epi16(_mm256_maskz_loadu_epi8(mask, mat + r * ld + i));
+#pragma GCC unroll 4
+      for (size_t v = 0; v < VECS; ++v) {
+        sum[r][v] = _mm512_add_epi32(sum[r][v], _mm512_madd_epi16(m, x[v]));
+      }
+    }
+  }
+  for (size_t r = 0; r < ROWS; ++r) {
+    for (size_t v = 0; v < VECS; ++v) {
+      acc[v * accStride + r] += _mm512_reduce_add_epi32(sum[r][v]);
+    }
+  }
+}
+
+// INT8 version of GemvBlockT for COLS x 32 rows, see pim_kernels_avx2.cpp.
+// The last 32 rows are limited to 'lastRows'.
+template <size_t COLS, size_t VECS>
+inline void GemvBlockTInt8(int32_t *acc, size_t accStride, const int8_t *mat,
+                           size_t ld, const int8_t *vec, size_t vecStride,
+                           size_t kc, size_t lastRows) {
+  constexpr size_t STEP = 32;
+  // Rows [0, 16) and [16, 32) of every 32 rows.
+  __m512i lo[COLS][VECS];
+  __m512i hi[COLS][VECS];
+#pragma GCC unroll 4
+  for (size_t c = 0; c < COLS; ++c) {
+#pragma GCC unroll 4
+    for (size_t v = 0; v < VECS; ++v) {
+      lo[c][v] = _mm512_setzero_si512();
+      hi[c][v] = _mm512_setzero_si512();
+    }
+  }
+  __mmask32 lastMask = (lastRows >= STEP) ? ~__mmask32{0}
+                                          : (__mmask32{1} << lastRows) - 1;
+  for (size_t i = 0; i < kc; i += 2) {
+    // An odd last column is paired with zeros.
+    bool pair = i + 1 < kc;
+    __m512i x[VECS];
+#pragma GCC unroll 4
+    for (size_t v = 0; v < VECS; ++v) {
+      const int8_t *xv = vec + v * vecStride + i;
+      int32_t next = pair ? xv[1] : 0;
+      x[v] = _mm512_set1_epi32(static_cast<int32_t>(
+          static_cast<uint16_t>(xv[0]) | (static_cast<uint32_t>(next) << 16)));
+    }
+#pragma GCC unroll 4
+    for (size_t c = 0; c < COLS; ++c) {
+      __mmask32 mask = (c + 1 == COLS) ? lastMask : ~__mmask32{0};
+      __m256i m0 = _mm256_maskz_loadu_epi8(mask, mat + i * ld + c * STEP);
+      __m256i m1 = _mm256_maskz_loadu_epi8(pair ? mask : 0,
+                                           mat + (i + 1) * ld + c * STEP);
+      // The unpacks work within 128-bit lanes, the permutations restore the
+      // order of the rows.
+      __m256i ilo = _mm256_unpacklo_epi8(m0, m1);
+      __m256i ihi = _mm256_unpackhi_epi8(m0, m1);
+      __m512i mlo =
+          _mm512_cvtepi8_epi16(_mm256_permute2x128_si256(ilo, ihi, 0x20));
+      __m512i mhi =
+          _mm512_cvtepi8_epi16(_mm256_permute2x128_si256(ilo, ihi, 0x31));
+#pragma GCC unroll 4
+      for (size_t v = 0; v < VECS; ++v) {
+        lo[c][v] = _mm512_add_epi32(lo[c][v], _mm512_madd_epi16(mlo, x[v]));
+        hi[c][v] = _mm512_add_epi32(hi[c][v], _mm512_madd_epi16(mhi, x[v]));
+      }
+    }
+  }
+#pragma GCC unroll 4
+  for (size_t c = 0; c < COLS; ++c) {
+    size_t rows = (c + 1 == COLS) ? lastRows : STEP;
+    __mmask16 loMask = TailMask(rows);
+    __mmask16 hiMask = TailMask(rows > LANES ? rows - LANES : 0);
+#pragma GCC unroll 4
+    for (size_t v = 0; v < VECS; ++v) {
+      int32_t *a = acc + v * accStride + c * STEP;
+      _mm512_mask_storeu_epi32(
+          a, loMask,
+          _mm512_add_epi32(_mm512_maskz_loadu_epi32(loMask, a), lo[c][v]));
+      _mm512_mask_storeu_epi32(
+          a + LANES, hiMask,
+          _mm512_add_epi32(_mm512_maskz_loadu_epi32(hiMask, a + LANES),
+                           hi[c][v]));
+    }
+  }
+}
+
+template <size_t N> struct Size {
+  static constexpr size_t value = N;
+};
+
+// Calls 'block(Size<R>(), Size<V>(), r, v)' for blocks of R rows and V vectors
+// starting at row r and vector v, covering the tile with ROWS x VECS blocks and
+// the remaining rows and vectors with smaller blocks. The vectors are the outer
+// loop, so that the tiles of VECS vectors stay in L1 while the matrix tile is
+// streamed from L2.
+template <size_t ROWS, size_t VECS, typename Block>
+inline void ForEachBlock(size_t numVecs, size_t numRows, Block block) {
+  size_t v = 0;
+  for (; v + VECS <= numVecs; v += VECS) {
+    size_t r = 0;
+    for (; r + ROWS <= numRows; r += ROWS) {
+      block(Size<ROWS>(), Size<VECS>(), r, v);
+    }
+    for (; r < numRows; ++r) {
+      block(Size<1>(), Size<VECS>(), r, v);
+    }
+  }
+  for (; v < numVecs; ++v) {
+    size_t r = 0;
+    for (; r + ROWS <= numRows; r += ROWS) {
+      block(Size<ROWS>(), Size<1>(), r, v);
+    }
+    for (; r < numRows; ++r) {
+      block(Size<1>(), Size<1>(), r, v);
+    }
+  }
+}
+
+} // anonymous namespace
+
+void Add(half_t *out, const half_t *in0, const half_t *in1, size_t count) {
+  Apply(
+      out, count,
+      [=](size_t i, __mmask16 m) {
+        return _mm512_add_ps(Load(in0 + i, m), Load(in1 + i, m));
+      },
+      [=](size_t i, size_t n) { scalar::Add(out + i, in0 + i, in1 + i, n); });
+}
+
+void AddScalar(half_t *out, const half_t *in, half_t value, size_t count) {
+  __m512 s = Broadcast(value);
+  Apply(
+      out, count,
+      [=](size_t i, __mmask16 m) { return _mm512_add_ps(Load(in + i, m), s); },
+      [=](size_t i, size_t n) {
+        scalar::AddScalar(out + i, in + i, value, n);
+      });
+}
+
+void Mul(half_t *out, const half_t *in0, const half_t *in1, size_t count) {
+  Apply(
+      out, count,
+      [=](size_t i, __mmask16 m) {
+        return _mm512_mul_ps(Load(in0 + i, m), Load(in1 + i, m));
+      },
+      [=](size_t i, size_t n) { scalar::Mul(out + i, in0 + i, in1 + i, n); });
+}
+
+void MulScalar(half_t *out, const half_t *in, half_t value, size_t count) {
+  __m512 s = Broadcast(value);
+  Apply(
+      out, count,
+      [=](size_t i, __mmask16 m) { return _mm512_mul_ps(Load(in + i, m), s); },
+      [=](size_t i, size_t n) {
+        scalar::MulScalar(out + i, in + i, value, n);
+      });
+}
+
+void Relu(half_t *out, const half_t *in, size_t count) {
+  // Works on the bits, see pim_kernels_avx2.cpp.
+  constexpr size_t STEP = 32;
+  const __m512i magnitude = _mm512_set1_epi16(0x7FFF);
+  const __m512i infinity = _mm512_set1_epi16(0x7C00);
+  for (size_t i = 0; i < count; i += STEP) {
+    size_t n = (count - i < STEP) ? count - i : STEP;
+    __mmask32 mask =
+        (n == STEP) ? 0xFFFFFFFF : static_cast<__mmask32>((1u << n) - 1u);
+    __m512i x = _mm512_maskz_loadu_epi16(mask, in + i);
+    if (_mm512_mask_cmpgt_epi16_mask(mask, _mm512_and_si512(x, magnitude),
+                                     infinity)) {
+      scalar::Relu(out + i, in + i, n);
+      continue;
+    }
+    _mm512_mask_storeu_epi16(out + i, mask,
+                             _mm512_andnot_si512(_mm512_srai_epi16(x, 15), x));
+  }
+}
+
+void BatchNorm(half_t *out, const half_t *in, half_t mean, half_t divisor,
+               half_t gamma, half_t beta, size_t count) {
+  // Rounds every intermediate result, see pim_kernels_avx2.cpp.
+  __m512 m = Broadcast(mean);
+  __m512 d = Broadcast(divisor);
+  __m512 g = Broadcast(gamma);
+  __m512 b = Broadcast(beta);
+  Apply(
+      out, count,
+      [=](size_t i, __mmask16 mask) {
+        __m512 norm = Round(
+            _mm512_div_ps(Round(_mm512_sub_ps(Load(in + i, mask), m)), d));
+        return _mm512_add_ps(Round(_mm512_mul_ps(g, norm)), b);
+      },
+      [=](size_t i, size_t n) {
+        scalar::BatchNorm(out + i, in + i, mean, divisor, gamma, beta, n);
+      });
+}
+
+void GemvTile(float *acc, size_t accStride, const half_t *mat, size_t ld,
+              const float *vec, size_t vecStride, size_t numVecs,
+              size_t numRows, size_t kc) {
+  auto block = [=](auto rows, auto vecs, size_t r, size_t v) {
+    GemvBlock<decltype(rows)::value, decltype(vecs)::value>(
+        acc + v * accStride + r, accStride, mat + r * ld, ld,
+        vec + v * vecStride, vecStride, kc);
+  };
+  // Both block shapes fit into the 32 zmm registers, the batched one uses
+  // 16 accumulators to load each matrix row once for 4 vectors.
+  if (numVecs == 1) {
+    ForEachBlock<4, 1>(numVecs, numRows, block);
+  } else {
+    ForEachBlock<2, 4>(numVecs, numRows, block);
+  }
+}
+
+void AddInt8(int8_t *out, const int8_t *in0, const int8_t *in1, size_t count) {
+  ApplyInt8(out, count, [=](size_t i, __mmask64 m) {
+    return _mm512_adds_epi8(_mm512_maskz_loadu_epi8(m, in0 + i),
+                            _mm512_maskz_loadu_epi8(m, in1 + i));
+  });
+}
+
+void AddScalarInt8(int8_t *out, const int8_t *in, int8_t value, size_t count) {
+  __m512i s = _mm512_set1_epi8(value);
+  ApplyInt8(out, count, [=](size_t i, __mmask64 m) {
+    return _mm512_adds_epi8(_mm512_maskz_loadu_epi8(m, in + i), s);
+  });
+}
+
+void MulInt8(int8_t *out, const int8_t *in0, const int8_t *in1, size_t count) {
+  ApplyInt8(out, count, [=](size_t i, __mmask64 m) {
+    return MulSaturateInt8(_mm512_maskz_loadu_epi8(m, in0 + i),
+                           _mm512_maskz_loadu_epi8(m, in1 + i));
+  });
+}
+
+void MulScalarInt8(int8_t *out, const int8_t *in, int8_t value, size_t count) {
+  __m512i s = _mm512_set1_epi8(value);
+  ApplyInt8(out, count, [=](size_t i, __mmask64 m) {
+    return MulSaturateInt8(_mm512_maskz_loadu_epi8(m, in + i), s);
+  });
+}
+
+void ReluInt8(int8_t *out, const int8_t *in, size_t count) {
+  __m512i zero = _mm512_setzero_si512();
+  ApplyInt8(out, count, [=](size_t i, __mmask64 m) {
+    return _mm512_max_epi8(_mm512_maskz_loadu_epi8(m, in + i), zero);
+  });
+}
+
+void GemvTileInt8(int32_t *acc, size_t accStride, const int8_t *mat, size_t ld,
+                  const int8_t *vec, size_t vecStride, size_t numVecs,
+                  size_t numRows, size_t kc) {
+  auto block = [=](auto rows, auto vecs, size_t r, size_t v) {
+    GemvBlockInt8<decltype(rows)::value, decltype(vecs)::value>(
+        acc + v * accStride + r, accStride, mat + r * ld, ld,
+        vec + v * vecStride, vecStride, kc);
+  };
+  if (numVecs == 1) {
+    ForEachBlock<4, 1>(numVecs, numRows, block);
+  } else {
+    ForEachBlock<4, 4>(numVecs, numRows, block);
+  }
+}
+
+void GemvTileT(float *acc, size_t accStride, const half_t *mat, size_t ld,
+               const float *vec, size_t vecStride, size_t numVecs,
+               size_t numRows, size_t kc) {
+  if (numRows == 0) {
+    return;
+  }
+  // Blocks of COLS x LANES rows, i.e., ForEachBlock counts groups of LANES
+  // rows, and the last group is masked.
+  size_t numGroups = (numRows + LANES - 1) / LANES;
+  __mmask16 tailMask = TailMask(numRows - (numGroups - 1) * LANES);
+  auto block = [=](auto cols, auto vecs, size_t c, size_t v) {
+    constexpr size_t COLS = decltype(cols)::value;
+    GemvBlockT<COLS, decltype(vecs)::value>(
+        acc + v * accStride + c * LANES, accStride, mat + c * LANES, ld,
+        vec + v * vecStride, vecStride, kc,
+        (c + COLS == numGroups) ? tailMask : FULL);
+  };
+  if (numVecs == 1) {
+    ForEachBlock<4, 1>(numVecs, numGroups, block);
+  } else {
+    ForEachBlock<4, 2>(numVecs, numGroups, block);
+  }
+}
+
+void GemvTileTInt8(int32_t *acc, size_t accStride, const int8_t *mat,
+                   size_t ld, const int8_t *vec, size_t vecStride,
+                   size_t numVecs, size_t numRows, size_t kc) {
+  constexpr size_t STEP = 32;
+  if (numRows == 0) {
+    return;
+  }
+  size_t numGroups = (numRows + STEP - 1) / STEP;
+  size_t tailRows = numRows - (numGroups - 1) * STEP;
+  auto block = [=](auto cols, auto vecs, size_t c, size_t v) {
+    constexpr size_t COLS = decltype(cols)::value;
+    GemvBlockTInt8<COLS, decltype(vecs)::value>(
+        acc + v * accStride + c * STEP, accStride, mat + c * STEP, ld,
+        vec + v * vecStride, vecStride, kc,
+        (c + COLS == numGroups) ? tailRows : STEP);
+  };
+  if (numVecs == 1) {
+    ForEachBlock<2, 1>(numVecs, numGroups, block);
+  } else {
+    ForEachBlock<2, 4>(numVecs, numGroups, block);
+  }
+}
+
+uint64_t FmaProbe(size_t iterations, float *sink) {
+  // Enough independent chains to cover the latency of two FMA ports.
+  constexpr size_t CHAINS = 12;
+  const __m512 factor = _mm512_set1_ps(0.999999f);
+  const __m512 addend = _mm512_set1_ps(1e-7f);
+  __m512 acc[CHAINS];
+  for (size_t c = 0; c < CHAINS; ++c) {
+    acc[c] = _mm512_set1_ps(static_cast<float>(c));
+  }
+  for (size_t i = 0; i < iterations; ++i) {
+    for (size_t c = 0; c < CHAINS; ++c) {
+      acc[c] = _mm512_fmadd_ps(acc[c], factor, addend);
+    }
+  }
+  for (size_t c = 1; c < CHAINS; ++c) {
+    acc[0] = _mm512_add_ps(acc[0], acc[c]);
+  }
+  float lanes[LANES];
+  _mm512_storeu_ps(lanes, acc[0]);
+  *sink = lanes[0];
+  return uint64_t{2} * LANES * CHAINS * iterations;
+}
+
+} // namespace avx512
+} // namespace kernels
+} // namespace mock
+} // namespace pim
@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2021 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system, or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+// This file is compiled with '-mavx512fp16 -mavx512bw -mavx512vl'. See
+// pim_kernels_avx2.cpp for the restrictions on code in this file.
+
+#include "pim_kernels.h"
+
+#include <cstdint>
+#include <immintrin.h>
+
+namespace pim {
+namespace mock {
+namespace kernels {
+namespace avx512fp16 {
+
+namespace {
+
+// Native FP16 arithmetic rounds to nearest-even exactly once, so the results
+// match half_t without any detour through FP32. As in the other vector
+// kernels, vectors producing NaNs are recomputed by the scalar kernel to get
+// the same NaN payloads as half.hpp.
+constexpr size_t LANES = 32;
+constexpr __mmask32 FULL = 0xFFFFFFFF;
+
+inline __m512h Load(const half_t *ptr, __mmask32 mask) {
+  return _mm512_castsi512_ph(_mm512_maskz_loadu_epi16(mask, ptr));
+}
+
+inline void Store(half_t *ptr, __m512h value, __mmask32 mask) {
+  _mm512_mask_storeu_epi16(ptr, mask, _mm512_castph_si512(value));
+}
+
+inline __m512h Broadcast(const half_t &value) {
+  uint16_t bits;
+  __builtin_memcpy(&bits, &value, sizeof(bits));
+  return _mm512_castsi512_ph(_mm512_set1_epi16(static_cast<short>(bits)));
+}
+
+// Stores 'op(i, mask)' for all vectors including the masked tail,
+// 'fallback(i, n)' recomputes the vectors containing NaNs.
+template <typename Op, typename Fallback>
+inline void Apply(half_t *out, size_t count, Op op, Fallback fallback) {
+  for (size_t i = 0; i < count; i += LANES) {
+    size_t n = (count - i < LANES) ? count - i : LANES;
+    __mmask32 mask =
+        (n == LANES) ? FULL : static_cast<__mmask32>((1u << n) - 1u);
+    __m512h result = op(i, mask);
+    if (_mm512_mask_cmp_ph_mask(mask, result, result, _CMP_UNORD_Q)) {
+      fallback(i, n);
+      continue;
+    }
+    Store(out + i, result, mask);
+  }
+}
+
+} // anonymous namespace
+
+void Add(half_t *out, const half_t *in0, const half_t *in1, size_t count) {
+  Apply(
+      out, count,
+      [=](size_t i, __mmask32 m) {
+        return _mm512_add_ph(Load(in0 + i, m), Load(in1 + i, m));
+      },
+      [=](size_t i, size_t n) { scalar::Add(out + i, in0 + i, in1 + i, n); });
+}
+
+void AddScalar(half_t *out, const half_t *in, half_t value, size_t count) {
+  __m512h s = Broadcast(value);
+  Apply(
+      out, count,
+      [=](size_t i, __mmask32 m) { return _mm512_add_ph(Load(in + i, m), s); },
+      [=](size_t i, size_t n) {
+        scalar::AddScalar(out + i, in + i, value, n);
+      });
+}
+
+void Mul(half_t *out, const half_t *in0, const half_t *in1, size_t count) {
+  Apply(
+      out, count,
+      [=](size_t i, __mmask32 m) {
+        return _mm512_mul_ph(Load(in0 + i, m), Load(in1 + i, m));
+      },
+      [=](size_t i, size_t n) { scalar::Mul(out + i, in0 + i, in1 + i, n); });
+}
+
+void MulScalar(half_t *out, const half_t *in, half_t value, size_t count) {
+  __m512h s = Broadcast(value);
+  Apply(
+      out, count,
+      [=](size_t i, __mmask32 m) { return _mm512_mul_ph(Load(in + i, m), s); },
+      [=](size_t i, size_t n) {
+        scalar::MulScalar(out + i, in + i, value, n);
+      });
+}
+
+} // namespace avx512fp16
+} // namespace kernels
+} // namespace mock
+} // namespace pim
@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2021 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system, or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+// This file is compiled with '-mavx512f -mavx512bw -mavx512vl -mavx512vnni'.
+// See pim_kernels_avx2.cpp for the restrictions on code in this file.
+
+#include "pim_kernels.h"
+
+#include <cstdint>
+#include <immintrin.h>
+
+namespace pim {
+namespace mock {
+namespace kernels {
+namespace avx512vnni {
+
+namespace {
+
+constexpr size_t STEP = 64;
+
+template <size_t N> struct Size {
+  static constexpr size_t value = N;
+};
+
+// Computes ROWS rows times VECS vectors of an INT8 GEMV tile with VPDPBUSD,
+// which multiplies unsigned by signed bytes and adds groups of 4 products to
+// INT32 lanes. The signed matrix elements m are made unsigned by flipping the
+// sign bit, i.e., m + 128, and the surplus 128 * sum(x) of each vector x is
+// subtracted at the end. The sums of the vectors are computed with VPDPBUSD
+// of a vector of ones and x. All arithmetic is exact.
+template <size_t ROWS, size_t VECS>
+inline void GemvBlockInt8(int32_t *acc, size_t accStride, const int8_t *mat,
+                          size_t ld, const int8_t *vec, size_t vecStride,
+                          size_t kc) {
+  const __m512i signBits = _mm512_set1_epi8(static_cast<char>(0x80));
+  const __m512i ones = _mm512_set1_epi8(1);
+  __m512i sum[ROWS][VECS];
+  __m512i vecSum[VECS];
+#pragma GCC unroll 4
+  for (size_t v = 0; v < VECS; ++v) {
+    vecSum[v] = _mm512_setzero_si512();
+#pragma GCC unroll 4
+    for (size_t r = 0; r < ROWS; ++r) {
+      sum[r][v] = _mm512_setzero_si512();
+    }
+  }
+  for (size_t i = 0; i < kc; i += STEP) {
+    size_t n = (kc - i < STEP) ? kc - i : STEP;
+    __mmask64 mask = (n == STEP) ? ~__mmask64{0} : (__mmask64{1} << n) - 1;
+    __m512i x[VECS];
+#pragma GCC unroll 4
+    for (size_t v = 0; v < VECS; ++v) {
+      x[v] = _mm512_maskz_loadu_epi8(mask, vec + v * vecStride + i);
+      vecSum[v] = _mm512_dpbusd_epi32(vecSum[v], ones, x[v]);
+    }
+#pragma GCC unroll 4
+    for (size_t r = 0; r < ROWS; ++r) {
+      // Masked-off elements become 128, but are multiplied by zeros.
+      __m512i m = _mm512_xor_si512(
+          _mm512_maskz_loadu_epi8(mask, mat + r * ld + i), signBits);
+#pragma GCC unroll 4
+      for (size_t v = 0; v < VECS; ++v) {
+        sum[r][v] = _mm512_dpbusd_epi32(sum[r][v], m, x[v]);
+      }
+    }
+  }
+  for (size_t v = 0; v < VECS; ++v) {
+    int32_t correction = 128 * _mm512_reduce_add_epi32(vecSum[v]);
+    for (size_t r = 0; r < ROWS; ++r) {
+      acc[v * accStride + r] +=
+          _mm512_reduce_add_epi32(sum[r][v]) - correction;
+    }
+  }
+}
+
+// See pim_kernels_avx2.cpp.
+template <size_t ROWS, size_t VECS, typename Block>
+inline void ForEachBlock(size_t numVecs, size_t numRows, Block block) {
+  size_t v = 0;
+  for (; v + VECS <= numVecs; v += VECS) {
+    size_t r = 0;
+    for (; r + ROWS <= numRows; r += ROWS) {
+      block(Size<ROWS>(), Size<VECS>(), r, v);
+    }
+    for (; r < numRows; ++r) {
+      block(Size<1>(), Size<VECS>(), r, v);
+    }
+  }
+  for (; v < numVecs; ++v) {
+    size_t r = 0;
+    for (; r + ROWS <= numRows; r += ROWS) {
+      block(Size<ROWS>(), Size<1>(), r, v);
+    }
+    for (; r < numRows; ++r) {
+      block(Size<1>(), Size<1>(), r, v);
+    }
+  }
+}
+
+} // anonymous namespace
+
+void GemvTileInt8(int32_t *acc, size_t accStride, const int8_t *mat, size_t ld,
+                  const int8_t *vec, size_t vecStride, size_t numVecs,
+                  size_t numRows, size_t kc) {
+  auto block = [=](auto rows, auto vecs, size_t r, size_t v) {
+    GemvBlockInt8<decltype(rows)::value, decltype(vecs)::value>(
+        acc + v * accStride + r, accStride, mat + r * ld, ld,
+        vec + v * vecStride, vecStride, kc);
+  };
+  if (numVecs == 1) {
+    ForEachBlock<4, 1>(numVecs, numRows, block);
+  } else {
+    ForEachBlock<4, 4>(numVecs, numRows, block);
+  }
+}
+
+} // namespace avx512vnni
+} // namespace kernels
+} // namespace mock
+} // namespace pim
@@ -0,0 +1,248 @@
+/*
+ * Copyright (C) 2021 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system, or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#include "pim_memory_pool.h"
+
+#include "pim_numa.h"
+#include <algorithm>
+#include <cstdlib>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace pim {
+namespace mock {
+
+namespace {
+
+// Rounds 'size' up to the next multiple of a quarter of the power of two below
+// it, i.e., wastes at most 25% for large blocks, and to a multiple of the
+// alignment, as required by aligned_alloc.
+size_t SizeClass(size_t size) {
+  if (size <= BUFFER_ALIGNMENT) {
+    return BUFFER_ALIGNMENT;
+  }
+  size_t log2 = 63 - __builtin_clzll(size - 1);
+  size_t step = std::max<size_t>(size_t{1} << (log2 - 2), BUFFER_ALIGNMENT);
+  return (size + step - 1) / step * step;
+}
+
+size_t PageSize() {
+#if defined(__linux__)
+  static const size_t pageSize = sysconf(_SC_PAGESIZE);
+  return pageSize;
+#else
+  return 4096;
+#endif
+}
+
+// Maps 'size' bytes, a multiple of the page size, backed by normal pages.
+// Returns nullptr if the memory could not be mapped.
+void *MapPages(size_t size) {
+#if defined(__linux__)
+  void *ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  return (ptr != MAP_FAILED) ? ptr : nullptr;
+#else
+  (void)size;
+  return nullptr;
+#endif
+}
+
+// Maps 'size' bytes, a multiple of the huge page size, backed by huge pages if
+// possible. Returns nullptr if the memory could not be mapped at all.
+void *MapHugePages(size_t size) {
+#if defined(__linux__) && defined(MAP_HUGETLB) && defined(MADV_HUGEPAGE)
+  constexpr size_t hugePage = MemoryPool::HUGE_PAGE_SIZE;
+  void *ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+  if (ptr != MAP_FAILED) {
+    return ptr;
+  }
+  // No explicit huge pages are reserved. Transparent huge pages need ranges
+  // aligned to the huge page size, so map one more huge page than needed and
+  // unmap the unaligned head and tail.
+  size_t mappedSize = size + hugePage;
+  ptr = mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE,
+             MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (ptr == MAP_FAILED) {
+    return nullptr;
+  }
+  char *mapped = static_cast<char *>(ptr);
+  char *aligned = reinterpret_cast<char *>(
+      (reinterpret_cast<uintptr_t>(mapped) + hugePage - 1) & ~(hugePage - 1));
+  if (aligned != mapped) {
+    munmap(mapped, aligned - mapped);
+  }
+  size_t tail = mapped + mappedSize - (aligned + size);
+  if (tail) {
+    munmap(aligned + size, tail);
+  }
+  // Only a hint, which fails if transparent huge pages are disabled.
+  madvise(aligned, size, MADV_HUGEPAGE);
+  return aligned;
+#else
+  (void)size;
+  return nullptr;
+#endif
+}
+
+} // anonymous namespace
+
+MemoryPool::~MemoryPool() { SetCacheLimit(0); }
+
+void MemoryPool::Release(void *ptr, const Block &block) {
+#if defined(__linux__)
+  if (block.mapped) {
+    munmap(ptr, block.blockClass.size);
+    return;
+  }
+#endif
+  std::free(ptr);
+}
+
+void *MemoryPool::Allocate(size_t size, bool hugePages, int node) {
+  if (size > SIZE_MAX / 2) {
+    return nullptr;
+  }
+  size_t sizeClass = SizeClass(size);
+  hugePages = hugePages && sizeClass >= HUGE_PAGE_SIZE;
+  if (hugePages) {
+    // Huge pages are coarse enough classes, rounding the size class up to them
+    // would waste almost a huge page more.
+    sizeClass = (size + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+  }
+  // Blocks below a page come from the heap, which cannot place them.
+  if (sizeClass < PageSize()) {
+    node = -1;
+  } else if (node >= 0) {
+    sizeClass = (sizeClass + PageSize() - 1) / PageSize() * PageSize();
+  }
+  BlockClass blockClass{sizeClass, hugePages, node};
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    ++stats.allocations;
+    if (stats.bytesInUse > budget || sizeClass > budget - stats.bytesInUse) {
+      return nullptr;
+    }
+    auto cached = cachedBlocks.find(blockClass);
+    if (cached != cachedBlocks.end() && !cached->second.empty()) {
+      void *ptr = cached->second.back();
+      cached->second.pop_back();
+      ++stats.hits;
+      stats.bytesCached -= sizeClass;
+      stats.bytesInUse += sizeClass;
+      return ptr;
+    }
+    // Reserve the block within the budget.
+    stats.bytesInUse += sizeClass;
+  }
+  // Allocate outside the lock, new blocks are the slow path.
+  Block block{blockClass, false};
+  void *ptr = nullptr;
+  if (hugePages) {
+    ptr = MapHugePages(sizeClass);
+  }
+  if (!ptr && node >= 0) {
+    ptr = MapPages(sizeClass);
+  }
+  block.mapped = ptr != nullptr;
+  if (ptr) {
+    // The pages are not touched yet, so they are all placed on the node.
+    BindMemoryToNode(ptr, sizeClass, node);
+  } else {
+    ptr = std::aligned_alloc(BUFFER_ALIGNMENT, sizeClass);
+  }
+  std::lock_guard<std::mutex> lock(mutex);
+  if (!ptr) {
+    stats.bytesInUse -= sizeClass;
+    return nullptr;
+  }
+  blocks.emplace(ptr, block);
+  return ptr;
+}
+
+bool MemoryPool::Free(void *ptr) {
+  if (!ptr) {
+    return true;
+  }
+  Block released;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto block = blocks.find(ptr);
+    if (block == blocks.end()) {
+      return false;
+    }
+    size_t sizeClass = block->second.blockClass.size;
+    stats.bytesInUse -= sizeClass;
+    if (stats.bytesCached + sizeClass <= cacheLimit) {
+      cachedBlocks[block->second.blockClass].push_back(ptr);
+      stats.bytesCached += sizeClass;
+      return true;
+    }
+    released = block->second;
+    blocks.erase(block);
+  }
+  Release(ptr, released);
+  return true;
+}
+
+void MemoryPool::SetCacheLimit(size_t limit) {
+  std::vector<std::pair<void *, Block>> released;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    cacheLimit = limit;
+    for (auto &cached : cachedBlocks) {
+      while (stats.bytesCached > cacheLimit && !cached.second.empty()) {
+        void *ptr = cached.second.back();
+        cached.second.pop_back();
+        auto block = blocks.find(ptr);
+        released.emplace_back(ptr, block->second);
+        blocks.erase(block);
+        stats.bytesCached -= cached.first.size;
+      }
+    }
+  }
+  for (const auto &block : released) {
+    Release(block.first, block.second);
+  }
+}
+
+void MemoryPool::SetBudget(size_t bytes) {
+  std::lock_guard<std::mutex> lock(mutex);
+  budget = bytes;
+}
+
+size_t MemoryPool::Budget() {
+  std::lock_guard<std::mutex> lock(mutex);
+  return budget;
+}
+
+MemoryPool::Stats MemoryPool::GetStats() {
+  std::lock_guard<std::mutex> lock(mutex);
+  return stats;
+}
+
+size_t DefaultPoolCacheLimit() {
+  if (const char *env = std::getenv("PIMMOCK_POOL_LIMIT")) {
+    char *end = nullptr;
+    unsigned long long value = std::strtoull(env, &end, 10);
+    if (end != env && *end == '\0') {
+      return value;
+    }
+  }
+  return size_t{1} << 30;
+}
+
+} // namespace mock
+} // namespace pim
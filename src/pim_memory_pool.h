@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2021 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system, or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#ifndef _PIM_MEMORY_POOL_H_
+#define _PIM_MEMORY_POOL_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#ifndef PIMMOCK_BUFFER_ALIGNMENT
+#define PIMMOCK_BUFFER_ALIGNMENT 64
+#endif
+
+namespace pim {
+namespace mock {
+
+// Alignment of all buffers in bytes, set with the CMake option of the same
+// name.
+constexpr size_t BUFFER_ALIGNMENT = PIMMOCK_BUFFER_ALIGNMENT;
+static_assert(BUFFER_ALIGNMENT >= 64 &&
+                  (BUFFER_ALIGNMENT & (BUFFER_ALIGNMENT - 1)) == 0,
+              "The buffer alignment must be a power of two of at least 64");
+
+// Thread-safe allocator for the memory of buffers. Requests are rounded up to
+// size classes, four per power of two, and freed blocks are cached per size
+// class, so that buffers which are repeatedly created and destroyed reuse
+// memory that is already mapped instead of paying for mmap, munmap and page
+// faults every time. All blocks are aligned to BUFFER_ALIGNMENT. Large blocks
+// may be backed by huge pages, which are aligned to HUGE_PAGE_SIZE.
+class MemoryPool {
+public:
+  struct Stats {
+    uint64_t allocations = 0;
+    // Allocations served by a cached block.
+    uint64_t hits = 0;
+    size_t bytesInUse = 0;
+    size_t bytesCached = 0;
+  };
+
+  MemoryPool() = default;
+  ~MemoryPool();
+
+  MemoryPool(const MemoryPool &) = delete;
+  MemoryPool &operator=(const MemoryPool &) = delete;
+
+  // Returns a block of at least 'size' bytes, nullptr if out of memory. If
+  // 'hugePages' is set and the block spans at least one huge page, its size is
+  // rounded up to a multiple of the huge page size, and it is backed by
+  // explicit huge pages (MAP_HUGETLB) if the system has reserved any, or by
+  // transparent huge pages otherwise, if enabled. If neither is available, the
+  // block uses normal pages. Blocks spanning at least one page are placed on
+  // the NUMA node 'node', unless it is -1, see pim_numa.h.
+  void *Allocate(size_t size, bool hugePages = false, int node = -1);
+
+  // Returns a block of Allocate to the pool, which caches it if the cached
+  // blocks stay within the cache limit and releases it otherwise. Returns
+  // false if 'ptr' was not allocated by the pool, nullptr is ignored.
+  bool Free(void *ptr);
+
+  // Sets the maximum number of bytes of cached blocks, releasing cached blocks
+  // beyond the new limit. A limit of 0 disables caching.
+  void SetCacheLimit(size_t limit);
+
+  // Sets the maximum number of bytes in use, i.e., allocated and not freed.
+  // Allocations beyond the budget fail. SIZE_MAX for no limit.
+  void SetBudget(size_t bytes);
+
+  size_t Budget();
+
+  Stats GetStats();
+
+  static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+  static_assert(BUFFER_ALIGNMENT <= HUGE_PAGE_SIZE,
+                "Huge pages must satisfy the buffer alignment");
+
+private:
+  // Blocks are cached by size class, whether huge pages were requested and
+  // their NUMA node.
+  struct BlockClass {
+    size_t size;
+    bool hugePages;
+    int node;
+
+    bool operator<(const BlockClass &other) const {
+      return std::tie(size, hugePages, node) <
+             std::tie(other.size, other.hugePages, other.node);
+    }
+  };
+
+  struct Block {
+    BlockClass blockClass;
+    // Mapped with mmap rather than allocated from the heap.
+    bool mapped;
+  };
+
+  static void Release(void *ptr, const Block &block);
+
+  std::mutex mutex;
+  size_t cacheLimit = 0;
+  size_t budget = SIZE_MAX;
+  Stats stats;
+  // Every block allocated and not yet released.
+  std::unordered_map<void *, Block> blocks;
+  std::map<BlockClass, std::vector<void *>> cachedBlocks;
+};
+
+// Cache limit of the runtime's pool while PIM is initialized: the value of the
+// environment variable PIMMOCK_POOL_LIMIT in bytes if set, 1 GiB otherwise.
+size_t DefaultPoolCacheLimit();
+
+} // namespace mock
+} // namespace pim
+
+#endif /* _PIM_MEMORY_POOL_H_ */
@@ -0,0 +1,140 @@
+/*
+ * Copyright (C) 2021 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system, or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#include "pim_numa.h"
+
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#if defined(PIMMOCK_HAVE_NUMA)
+#include <numa.h>
+#include <numaif.h>
+#endif
+
+namespace pim {
+namespace mock {
+
+namespace {
+
+#if defined(PIMMOCK_HAVE_NUMA)
+
+// Parses PIMMOCK_DEVICE_NODES, ignoring entries that are not nodes with
+// memory the process may use.
+std::vector<int> NodesFromEnvironment(const char *env) {
+  std::vector<int> nodes;
+  std::string list(env);
+  size_t begin = 0;
+  while (begin <= list.size()) {
+    size_t end = list.find(',', begin);
+    if (end == std::string::npos) {
+      end = list.size();
+    }
+    std::string entry = list.substr(begin, end - begin);
+    char *last = nullptr;
+    long node = std::strtol(entry.c_str(), &last, 10);
+    if (!entry.empty() && *last == '\0' && node >= 0 &&
+        node <= numa_max_node() &&
+        numa_bitmask_isbitset(numa_all_nodes_ptr, node)) {
+      nodes.push_back(static_cast<int>(node));
+    }
+    begin = end + 1;
+  }
+  return nodes;
+}
+
+#endif
+
+// The nodes the devices are assigned to, empty for no placement.
+std::vector<int> deviceNodes;
+
+} // anonymous namespace
+
+void LoadDeviceNodes() {
+  deviceNodes.clear();
+#if defined(PIMMOCK_HAVE_NUMA)
+  if (numa_available() < 0) {
+    return;
+  }
+  if (const char *env = std::getenv("PIMMOCK_DEVICE_NODES")) {
+    deviceNodes = NodesFromEnvironment(env);
+    return;
+  }
+  for (int node = 0; node <= numa_max_node(); ++node) {
+    if (numa_bitmask_isbitset(numa_all_nodes_ptr, node)) {
+      deviceNodes.push_back(node);
+    }
+  }
+  // A single node needs no placement.
+  if (deviceNodes.size() < 2) {
+    deviceNodes.clear();
+  }
+#endif
+}
+
+int DeviceNumaNode(uint32_t deviceId) {
+  if (deviceNodes.empty()) {
+    return -1;
+  }
+  return deviceNodes[deviceId % deviceNodes.size()];
+}
+
+size_t NumNodeCpus(int node) {
+#if defined(PIMMOCK_HAVE_NUMA)
+  if (node < 0) {
+    return 0;
+  }
+  struct bitmask *cpus = numa_allocate_cpumask();
+  size_t count = 0;
+  if (numa_node_to_cpus(node, cpus) == 0) {
+    for (unsigned int cpu = 0; cpu < cpus->size; ++cpu) {
+      count += numa_bitmask_isbitset(cpus, cpu) &&
+               numa_bitmask_isbitset(numa_all_cpus_ptr, cpu);
+    }
+  }
+  numa_free_cpumask(cpus);
+  return count;
+#else
+  (void)node;
+  return 0;
+#endif
+}
+
+void BindThreadToNode(int node) {
+#if defined(PIMMOCK_HAVE_NUMA)
+  if (node >= 0) {
+    numa_run_on_node(node);
+  }
+#else
+  (void)node;
+#endif
+}
+
+void BindMemoryToNode(void *ptr, size_t size, int node) {
+#if defined(PIMMOCK_HAVE_NUMA)
+  if (node < 0) {
+    return;
+  }
+  // Preferred rather than bound, so that allocations still succeed if the
+  // node runs out of memory.
+  struct bitmask *nodes = numa_allocate_nodemask();
+  numa_bitmask_setbit(nodes, node);
+  mbind(ptr, size, MPOL_PREFERRED, nodes->maskp, nodes->size + 1, 0);
+  numa_free_nodemask(nodes);
+#else
+  (void)ptr;
+  (void)size;
+  (void)node;
+#endif
+}
+
+} // namespace mock
+} // namespace pim
@@ -0,0 +1,51 @@
+/*
+ * Copyright (C) 2021 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system, or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#ifndef _PIM_NUMA_H_
+#define _PIM_NUMA_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace pim {
+namespace mock {
+
+// NUMA placement of the emulated devices. Every device id is mapped to a NUMA
+// node, which holds the memory of the buffers allocated while the device is
+// current and runs its compute threads. All functions fall back to no
+// placement (node -1) if PIMMock is built without libnuma or the kernel does
+// not support NUMA.
+
+// Reads the nodes of the devices from the environment variable
+// PIMMOCK_DEVICE_NODES, a comma-separated list of node ids assigned to the
+// devices round-robin. Defaults to all nodes with memory if the host has more
+// than one, and to no placement otherwise. Called by PimInitialize.
+void LoadDeviceNodes();
+
+// Node of the device 'deviceId', -1 for no placement.
+int DeviceNumaNode(uint32_t deviceId);
+
+// Number of CPUs of 'node' the process may run on, 0 for node -1.
+size_t NumNodeCpus(int node);
+
+// Restricts the calling thread to the CPUs of 'node'. Does nothing for node
+// -1 or if the affinity cannot be set.
+void BindThreadToNode(int node);
+
+// Makes the pages of the mapping [ptr, ptr + size) prefer 'node', which takes
+// effect as the pages are first touched. 'ptr' must be page-aligned. Does
+// nothing for node -1.
+void BindMemoryToNode(void *ptr, size_t size, int node);
+
+} // namespace mock
+} // namespace pim
+
+#endif /* _PIM_NUMA_H_ */
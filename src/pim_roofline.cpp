@@ -0,0 +1,226 @@
+/*
+ * Copyright (C) 2021 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system, or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#include "pim_roofline.h"
+
+#include "pim_kernels.h"
+#include "pim_thread_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace pim {
+namespace mock {
+
+namespace {
+
+constexpr size_t PROBE_REPETITIONS = 5;
+constexpr size_t STREAM_GRAIN = 64 * 1024;      // elements
+constexpr size_t FMA_ITERATIONS = 256 * 1024;  // per chunk
+// Several chunks per thread, so threads that start late get fewer chunks.
+constexpr size_t FMA_CHUNKS_PER_THREAD = 4;
+
+std::mutex peaksMutex;
+MachinePeaks probedPeaks;
+std::atomic<bool> enabled{false};
+
+double Seconds(TraceClock::duration duration) {
+  return std::chrono::duration<double>(duration).count();
+}
+
+// The best of the STREAM copy a[i] = b[i], done by memcpy, and the STREAM
+// triad a[i] = b[i] + s * c[i]. Like STREAM, the bytes count the arrays
+// once, without the reads of the written cache lines.
+double ProbeBandwidth(size_t arrayBytes) {
+  size_t count = std::max<size_t>(arrayBytes / sizeof(float), 1);
+  std::unique_ptr<float[]> a(new float[count]);
+  std::unique_ptr<float[]> b(new float[count]);
+  std::unique_ptr<float[]> c(new float[count]);
+  float *pa = a.get();
+  float *pb = b.get();
+  float *pc = c.get();
+  // First touched by the threads of the pool, i.e., on their NUMA node.
+  ParallelFor(count, STREAM_GRAIN, [=](size_t begin, size_t end) {
+    std::fill(pa + begin, pa + end, 0.0f);
+    std::fill(pb + begin, pb + end, 1.0f);
+    std::fill(pc + begin, pc + end, 2.0f);
+  });
+  const float scalar = 3.0f;
+  double best = 0;
+  for (size_t r = 0; r < PROBE_REPETITIONS; ++r) {
+    TraceClock::time_point start = TraceClock::now();
+    ParallelFor(count, STREAM_GRAIN, [=](size_t begin, size_t end) {
+      std::memcpy(pa + begin, pb + begin, (end - begin) * sizeof(float));
+    });
+    double seconds = Seconds(TraceClock::now() - start);
+    best = std::max(best, 2.0 * count * sizeof(float) / seconds);
+
+    start = TraceClock::now();
+    ParallelFor(count, STREAM_GRAIN, [=](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        pa[i] = pb[i] + scalar * pc[i];
+      }
+    });
+    seconds = Seconds(TraceClock::now() - start);
+    best = std::max(best, 3.0 * count * sizeof(float) / seconds);
+  }
+  return best;
+}
+
+double ProbeFlops() {
+  kernels::FmaProbeFn probe = kernels::GetKernels().fmaProbe;
+  std::shared_ptr<ThreadPool> pool = CurrentThreadPool();
+  size_t numChunks =
+      (pool ? pool->NumThreads() : 1) * FMA_CHUNKS_PER_THREAD;
+  std::vector<float> sinks(numChunks);
+  double best = 0;
+  for (size_t r = 0; r < PROBE_REPETITIONS; ++r) {
+    std::atomic<uint64_t> ops{0};
+    TraceClock::time_point start = TraceClock::now();
+    ParallelFor(numChunks, 1, [&](size_t begin, size_t end) {
+      uint64_t chunkOps = 0;
+      for (size_t chunk = begin; chunk < end; ++chunk) {
+        chunkOps += probe(FMA_ITERATIONS, &sinks[chunk]);
+      }
+      ops.fetch_add(chunkOps, std::memory_order_relaxed);
+    });
+    double seconds = Seconds(TraceClock::now() - start);
+    best = std::max(best, ops.load(std::memory_order_relaxed) / seconds);
+  }
+  return best;
+}
+
+bool Requested(const char *env) {
+  return env && *env && std::strcmp(env, "0") != 0;
+}
+
+} // anonymous namespace
+
+MachinePeaks ProbeMachinePeaks(size_t arrayBytes) {
+  MachinePeaks peaks;
+  peaks.bytesPerSecond = ProbeBandwidth(arrayBytes);
+  peaks.flopsPerSecond = ProbeFlops();
+  std::lock_guard<std::mutex> lock(peaksMutex);
+  probedPeaks = peaks;
+  enabled.store(true, std::memory_order_relaxed);
+  return peaks;
+}
+
+MachinePeaks GetMachinePeaks() {
+  std::lock_guard<std::mutex> lock(peaksMutex);
+  return probedPeaks;
+}
+
+bool RooflineEnabled() { return enabled.load(std::memory_order_relaxed); }
+
+uint64_t OpsPerElement(ApiFunction function) {
+  switch (function) {
+  case ApiFunction::EXECUTE_ADD:
+  case ApiFunction::EXECUTE_MUL:
+  case ApiFunction::EXECUTE_RELU:
+    return 1;
+  // A multiply-add per element, the addend of PimExecuteGemvAdd is ignored.
+  case ApiFunction::EXECUTE_GEMV:
+  case ApiFunction::EXECUTE_GEMV_ADD:
+  case ApiFunction::EXECUTE_GEMV_LIST:
+    return 2;
+  // Subtraction of the mean, division, multiplication and addition.
+  case ApiFunction::EXECUTE_BN:
+    return 4;
+  default:
+    return 0;
+  }
+}
+
+RooflinePoint GetRooflinePoint(ApiFunction function,
+                               const ApiFunctionStats &stats,
+                               const MachinePeaks &peaks) {
+  RooflinePoint point;
+  point.executions = stats.executions;
+  point.totalNs = stats.executionNs;
+  if (!stats.executionNs) {
+    return point;
+  }
+  double seconds = stats.executionNs * 1e-9;
+  double bytes = static_cast<double>(stats.executedBytes);
+  double flops =
+      static_cast<double>(stats.executedElements * OpsPerElement(function));
+  point.bytesPerSecond = bytes / seconds;
+  point.flopsPerSecond = flops / seconds;
+  point.intensity = bytes > 0 ? flops / bytes : 0;
+  if (peaks.bytesPerSecond > 0 && peaks.flopsPerSecond > 0) {
+    point.computeBound =
+        point.intensity * peaks.bytesPerSecond > peaks.flopsPerSecond;
+    point.roofFraction =
+        std::max(point.flopsPerSecond / peaks.flopsPerSecond,
+                 point.bytesPerSecond / peaks.bytesPerSecond);
+  }
+  return point;
+}
+
+void DumpRoofline(std::FILE *out) {
+  MachinePeaks peaks = GetMachinePeaks();
+  ApiStats stats = GetApiStats();
+  std::fprintf(out,
+               "PIMMock roofline: %.2f GB/s, %.2f GFLOP/s, ridge at %.2f "
+               "FLOP/B\n",
+               peaks.bytesPerSecond * 1e-9, peaks.flopsPerSecond * 1e-9,
+               peaks.bytesPerSecond > 0
+                   ? peaks.flopsPerSecond / peaks.bytesPerSecond
+                   : 0.0);
+  std::fprintf(out, "%-22s %10s %12s %10s %10s %10s %10s %8s\n",
+               "PIMMock API", "executions", "total [ms]", "GB/s", "GFLOP/s",
+               "FLOP/B", "roof [%]", "bound");
+  for (size_t f = 0; f < NUM_API_FUNCTIONS; ++f) {
+    ApiFunction function = static_cast<ApiFunction>(f);
+    RooflinePoint point = GetRooflinePoint(function, stats[f], peaks);
+    if (!point.executions) {
+      continue;
+    }
+    std::fprintf(out,
+                 "%-22s %10llu %12.3f %10.2f %10.2f %10.3f %10.1f %8s\n",
+                 ApiFunctionName(function),
+                 static_cast<unsigned long long>(point.executions),
+                 point.totalNs * 1e-6, point.bytesPerSecond * 1e-9,
+                 point.flopsPerSecond * 1e-9, point.intensity,
+                 point.roofFraction * 100,
+                 point.computeBound ? "compute" : "memory");
+  }
+  std::fflush(out);
+}
+
+void ProbeMachinePeaksIfRequested() {
+  if (Requested(std::getenv("PIMMOCK_ROOFLINE")) && !RooflineEnabled()) {
+    ProbeMachinePeaks();
+  }
+}
+
+void DumpRooflineIfRequested() {
+  const char *env = std::getenv("PIMMOCK_ROOFLINE");
+  if (!Requested(env)) {
+    return;
+  }
+  if (std::strcmp(env, "1") == 0) {
+    DumpRoofline(stderr);
+    return;
+  }
+  if (std::FILE *file = std::fopen(env, "a")) {
+    DumpRoofline(file);
+    std::fclose(file);
+  }
+}
+
+} // namespace mock
+} // namespace pim
@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2021 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system, or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#ifndef _PIM_ROOFLINE_H_
+#define _PIM_ROOFLINE_H_
+
+#include "pim_api_stats.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+namespace pim {
+namespace mock {
+
+// The roofline model bounds the FLOP rate of an operation with arithmetic
+// intensity I (FLOP per byte) by min(peak FLOP rate, I * peak bandwidth). The
+// peaks of the host are probed with STREAM-like kernels, and every executed
+// operation is then compared with its roof, which shows whether a slow
+// operation is limited by its kernel or by the hardware.
+
+struct MachinePeaks {
+  // Sustainable memory bandwidth of the STREAM copy and triad, in bytes per
+  // second.
+  double bytesPerSecond = 0;
+  // FP32 throughput of independent multiply-adds, in FLOP per second.
+  double flopsPerSecond = 0;
+};
+
+// Size of each of the arrays of the STREAM kernels, larger than the caches
+// of most hosts.
+constexpr size_t STREAM_ARRAY_BYTES = 64 * 1024 * 1024;
+
+// Measures the peaks on the thread pool of the current device, or on the
+// calling thread if no pool is running, with the FP32 kernels selected by
+// GetKernels, and enables the roofline accounting of executed operations,
+// see RooflineEnabled. The peaks are the best of several repetitions.
+MachinePeaks ProbeMachinePeaks(size_t arrayBytes = STREAM_ARRAY_BYTES);
+
+// The peaks of the last probe, zero before the first probe.
+MachinePeaks GetMachinePeaks();
+
+// Whether the executions of operations are counted, see CountExecution.
+// Enabled by the first probe.
+bool RooflineEnabled();
+
+// Arithmetic operations per element counted by the calls of 'function', 0
+// for functions without arithmetic, e.g., copies. INT8 operations count like
+// FP32 operations and are compared with the same roof.
+uint64_t OpsPerElement(ApiFunction function);
+
+// The executions of the operations of one function, compared with the roof.
+struct RooflinePoint {
+  uint64_t executions = 0;
+  uint64_t totalNs = 0;
+  double bytesPerSecond = 0;
+  double flopsPerSecond = 0;
+  // FLOP per byte.
+  double intensity = 0;
+  // Achieved fraction of the roof at the intensity of the operations, i.e.,
+  // max(FLOP rate / peak FLOP rate, bandwidth / peak bandwidth), 0 before the
+  // first probe.
+  double roofFraction = 0;
+  // Whether the roof at the intensity of the operations is the FLOP peak
+  // rather than the bandwidth peak.
+  bool computeBound = false;
+};
+
+// The roofline point of 'function' given its statistics and the peaks.
+RooflinePoint GetRooflinePoint(ApiFunction function,
+                               const ApiFunctionStats &stats,
+                               const MachinePeaks &peaks);
+
+// Writes the peaks and the roofline points of the functions executed since
+// the last ResetApiStats as a table to 'out'.
+void DumpRoofline(std::FILE *out);
+
+// Probes the peaks if the environment variable PIMMOCK_ROOFLINE is set and
+// they were not probed yet. Called by PimInitialize.
+void ProbeMachinePeaksIfRequested();
+
+// Dumps the roofline if requested by the environment variable
+// PIMMOCK_ROOFLINE, to the standard error stream if it is "1", or appended
+// to the file it names otherwise. Called by PimDeinitialize.
+void DumpRooflineIfRequested();
+
+} // namespace mock
+} // namespace pim
+
+#endif /* _PIM_ROOFLINE_H_ */
@@ -18,44 +18,224 @@
 #include "pim_runtime_api.h"
 
 #include "half.hpp"
+#include "pim_api_stats.h"
+#include "pim_copy_engine.h"
+#include "pim_device.h"
+#include "pim_graph.h"
+#include "pim_kernels.h"
+#include "pim_memory_pool.h"
+#include "pim_mock_api.h"
+#include "pim_numa.h"
+#include "pim_roofline.h"
+#include "pim_stream.h"
+#include "pim_thread_pool.h"
+#include "pim_trace.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <cassert>
 #include <cstdlib>
 #include <cstring>
+#include <functional>
+#include <initializer_list>
 #include <memory>
-
-using half_t = half_float::half;
+#include <tuple>
 
 namespace pim {
 namespace mock {
 
 namespace {
 enum ERROR_CODES : int {
+  // Not an error, returned by PimQueryEvent.
+  EVENT_PENDING = 1,
   SUCCESS = 0,
   ALLOC_ERROR = -1,
   COPY_ERROR = -2,
   OPERATION_ERROR = -3
 };
+
+// Minimum amount of work per thread when splitting operations across the
+// thread pool, smaller operations are executed by the calling thread only.
+constexpr size_t ELT_GRAIN = 32 * 1024;        // elements
+constexpr size_t ELT_ALIGN = 64;               // elements
+constexpr size_t COPY_GRAIN = 1024 * 1024;     // bytes
+constexpr size_t GEMV_GRAIN = 32 * 1024;       // multiply-adds
+
+// Thread count requested through PimSetNumThreads, 0 for the default.
+uint32_t requestedNumThreads = 0;
+
+// Set by PimSetDeferredExecution.
+std::atomic<bool> deferredExecution{false};
 } // anonymous namespace
 
+// Every function of the API measures its calls with an ApiCall, see
+// PimGetApiStats. The traffic of operations and copies is counted once their
+// operands were validated.
+
 int PimInitialize(PimRuntimeType, PimPrecision) {
-  // Currently nothing to do during initalization.
+  StartTraceIfRequested();
+  ApiCall call(ApiFunction::INITIALIZE);
+  kernels::SelectKernels(std::getenv("PIMMOCK_ISA"));
+  LoadDeviceNodes();
+  StartDevices(requestedNumThreads, DefaultCopyThreads(),
+               DefaultPoolCacheLimit(), DefaultDeviceMemory());
+  ProbeMachinePeaksIfRequested();
   return SUCCESS;
 }
 
 int PimDeinitialize() {
-  // Currently nothing to do during de-initialization.
+  ApiCall call(ApiFunction::DEINITIALIZE);
+  StopDevices();
+  DumpApiStatsIfRequested();
+  DumpRooflineIfRequested();
+  StopTrace();
+  return SUCCESS;
+}
+
+int PimSetNumThreads(uint32_t num_threads) {
+  requestedNumThreads = num_threads;
+  SetDeviceThreads(requestedNumThreads);
+  return SUCCESS;
+}
+
+uint32_t PimGetNumThreads() {
+  std::shared_ptr<ThreadPool> pool = CurrentThreadPool();
+  return pool ? static_cast<uint32_t>(pool->NumThreads()) : 1u;
+}
+
+int PimSetDeferredExecution(bool enable) {
+  deferredExecution.store(enable, std::memory_order_relaxed);
+  return SUCCESS;
+}
+
+const char *PimGetKernelIsa() { return kernels::GetKernels().isa; }
+
+int PimGetMemoryPoolStats(PimMemoryPoolStats *stats) {
+  if (!stats) {
+    return OPERATION_ERROR;
+  }
+  MemoryPool &memory = CurrentDevice().Memory();
+  MemoryPool::Stats poolStats = memory.GetStats();
+  stats->num_allocations = poolStats.allocations;
+  stats->num_pool_hits = poolStats.hits;
+  stats->bytes_in_use = poolStats.bytesInUse;
+  stats->bytes_cached = poolStats.bytesCached;
+  size_t budget = memory.Budget();
+  stats->bytes_budget = (budget == SIZE_MAX) ? 0 : budget;
+  return SUCCESS;
+}
+
+int PimGetCopyEngineStats(PimCopyEngineStats *stats) {
+  if (!stats) {
+    return OPERATION_ERROR;
+  }
+  CopyEngine::Stats engineStats = CurrentDevice().Copies().GetStats();
+  stats->num_copies = engineStats.copies;
+  stats->bytes_copied = engineStats.bytes;
+  stats->queue_depth = engineStats.queueDepth;
+  stats->max_queue_depth = engineStats.maxQueueDepth;
+  stats->bytes_in_flight = engineStats.bytesInFlight;
+  return SUCCESS;
+}
+
+int PimGetApiStats(PimApiStats *stats, uint32_t *num_stats) {
+  if (!num_stats || (*num_stats && !stats)) {
+    return OPERATION_ERROR;
+  }
+  ApiStats apiStats = GetApiStats();
+  uint32_t count =
+      std::min(*num_stats, static_cast<uint32_t>(NUM_API_FUNCTIONS));
+  for (uint32_t f = 0; f < count; ++f) {
+    const ApiFunctionStats &function = apiStats[f];
+    stats[f].name = ApiFunctionName(static_cast<ApiFunction>(f));
+    stats[f].num_calls = function.calls;
+    stats[f].total_ns = function.totalNs;
+    stats[f].p50_ns = function.LatencyPercentile(0.5);
+    stats[f].p90_ns = function.LatencyPercentile(0.9);
+    stats[f].p99_ns = function.LatencyPercentile(0.99);
+    stats[f].max_ns = function.maxNs;
+    stats[f].bytes_read = function.bytesRead;
+    stats[f].bytes_written = function.bytesWritten;
+    stats[f].num_elements = function.elements;
+  }
+  *num_stats = static_cast<uint32_t>(NUM_API_FUNCTIONS);
+  return SUCCESS;
+}
+
+int PimResetApiStats() {
+  ResetApiStats();
+  return SUCCESS;
+}
+
+int PimProbeMachinePeaks(PimMachinePeaks *peaks) {
+  MachinePeaks probed = ProbeMachinePeaks();
+  if (peaks) {
+    peaks->bytes_per_sec = probed.bytesPerSecond;
+    peaks->flops_per_sec = probed.flopsPerSecond;
+  }
+  return SUCCESS;
+}
+
+int PimGetRooflineStats(PimRooflineStats *stats, uint32_t *num_stats) {
+  if (!num_stats || (*num_stats && !stats)) {
+    return OPERATION_ERROR;
+  }
+  MachinePeaks peaks = GetMachinePeaks();
+  ApiStats apiStats = GetApiStats();
+  uint32_t count =
+      std::min(*num_stats, static_cast<uint32_t>(NUM_API_FUNCTIONS));
+  for (uint32_t f = 0; f < count; ++f) {
+    ApiFunction function = static_cast<ApiFunction>(f);
+    RooflinePoint point = GetRooflinePoint(function, apiStats[f], peaks);
+    stats[f].name = ApiFunctionName(function);
+    stats[f].num_executions = point.executions;
+    stats[f].total_ns = point.totalNs;
+    stats[f].bytes_per_sec = point.bytesPerSecond;
+    stats[f].flops_per_sec = point.flopsPerSecond;
+    stats[f].intensity = point.intensity;
+    stats[f].roof_fraction = point.roofFraction;
+    stats[f].compute_bound = point.computeBound;
+  }
+  *num_stats = static_cast<uint32_t>(NUM_API_FUNCTIONS);
   return SUCCESS;
 }
 
+int PimStartTrace(const char *path) {
+  if (!path || !StartTrace(path)) {
+    return OPERATION_ERROR;
+  }
+  return SUCCESS;
+}
+
+int PimFlushTrace() {
+  FlushTrace();
+  return SUCCESS;
+}
+
+int PimStopTrace() {
+  StopTrace();
+  return SUCCESS;
+}
+
+int PimGetDeviceNumaNode(uint32_t device_id) {
+  return DeviceNumaNode(device_id);
+}
+
 int PimSetDevice(uint32_t device_id) {
-  (void)device_id;
-  // Currently nothing to do to switch devices.
+  ApiCall call(ApiFunction::SET_DEVICE);
+  // The device is selected per host thread, as in HIP. Buffers created from
+  // now on belong to the device, and operations run on its threads.
+  if (device_id >= MAX_DEVICES) {
+    return OPERATION_ERROR;
+  }
+  SetCurrentDevice(device_id);
   return SUCCESS;
 }
 
-size_t PrecisionSize(const PimBo *bo) {
-  assert(bo != nullptr && "Invalid buffer");
-  switch (bo->precision) {
+namespace {
+
+size_t ElementSize(PimPrecision precision) {
+  switch (precision) {
   case PIM_FP16:
     return sizeof(half_t);
   case PIM_INT8:
@@ -64,25 +244,110 @@ size_t PrecisionSize(const PimBo *bo) {
   }
 }
 
+} // anonymous namespace
+
+size_t PrecisionSize(const PimBo *bo) {
+  assert(bo != nullptr && "Invalid buffer");
+  return ElementSize(bo->precision);
+}
+
 namespace {
 
+// The storage of a raw buffer consists of 'count' rows of 'length' elements,
+// which start 'pitch' elements apart. The rows run along w, or along h for
+// buffers with the 't' flag set, which are stored column-major. bshape_r is
+// the shape of the storage, i.e., bshape with the rows padded, if any. Buffers
+// whose bshape_r does not describe such a padding of bshape, e.g., buffers
+// set up by the application, are packed.
+struct StorageRows {
+  size_t count;
+  size_t length;
+  size_t pitch;
+};
+
+StorageRows GetStorageRows(const PimBo *bo) {
+  const PimBShape &shape = bo->bshape;
+  const PimBShape &storage = bo->bshape_r;
+  size_t planes = size_t{shape.n} * shape.c;
+  bool padded = storage.c == shape.c && storage.n == shape.n;
+  if (shape.t) {
+    padded = padded && storage.w == shape.w && storage.h >= shape.h;
+    return {planes * shape.w, shape.h, padded ? storage.h : shape.h};
+  }
+  padded = padded && storage.h == shape.h && storage.w >= shape.w;
+  return {planes * shape.h, shape.w, padded ? storage.w : shape.w};
+}
+
+bool IsPacked(const PimBo *bo) {
+  StorageRows rows = GetStorageRows(bo);
+  return rows.pitch == rows.length;
+}
+
+// Rounds the row length 'length' up to a multiple of BUFFER_ALIGNMENT bytes.
+uint32_t PadRow(uint32_t length, size_t elementSize) {
+  size_t multiple = BUFFER_ALIGNMENT / elementSize;
+  return static_cast<uint32_t>((length + multiple - 1) / multiple * multiple);
+}
+
+// PIM and device buffers hold the weights and activations streamed by the
+// kernels, so large ones are backed by huge pages to avoid TLB misses. Host
+// buffers only stage copies and use normal pages.
+bool UseHugePages(PimMemType mem_type) {
+  return mem_type == MEM_TYPE_PIM || mem_type == MEM_TYPE_DEVICE;
+}
+
+// Waits for the operations enqueued on the streams of the current device and
+// of the devices of the buffers 'bos'. Copies and frees wait implicitly, as
+// in HIP, so that they see the results of all operations issued before.
+void WaitForOperations(std::initializer_list<const PimBo *> bos = {}) {
+  DeviceContext &current = CurrentDevice();
+  current.SynchronizeStreams();
+  for (const PimBo *bo : bos) {
+    if (bo && bo->device_id != current.Id()) {
+      GetDevice(bo->device_id).SynchronizeStreams();
+    }
+  }
+}
+
+// Frees the memory of 'bo' allocated by the runtime.
+void FreeMemory(const PimBo *bo) {
+  WaitForOperations({bo});
+  if (!GetDevice(bo->device_id).Memory().Free(bo->data)) {
+    // Memory of another device, assigned to the buffer by the application.
+    FreeDeviceMemory(bo->data);
+  }
+}
+
 int AllocateMemory(PimBo *bo, void *user_ptr) {
   assert(bo != nullptr && "Buffer not valid");
   size_t typeSize = PrecisionSize(bo);
-  auto bshape = bo->bshape;
-  size_t size = bshape.n * bshape.c * bshape.h * bshape.w * typeSize;
+  StorageRows rows = GetStorageRows(bo);
+  size_t size = rows.count * rows.pitch * typeSize;
   bo->size = size;
+  bo->data_layout = PIM_LAYOUT_RAW;
+  DeviceContext &device = CurrentDevice();
+  bo->device_id = device.Id();
   if (user_ptr) {
     bo->data = user_ptr;
     bo->use_user_ptr = true;
     return SUCCESS;
   }
-  auto *data = malloc(size);
+  auto *data = device.Memory().Allocate(size, UseHugePages(bo->mem_type),
+                                        DeviceNumaNode(device.Id()));
   if (!data) {
     return ALLOC_ERROR;
   }
   bo->data = data;
   bo->use_user_ptr = false;
+  if (rows.pitch != rows.length) {
+    // The element-wise kernels also process the padding, which is zeroed so
+    // that it does not hold arbitrary values, such as denormals.
+    auto *bytes = static_cast<char *>(data);
+    for (size_t row = 0; row < rows.count; ++row) {
+      std::memset(bytes + (row * rows.pitch + rows.length) * typeSize, 0,
+                  (rows.pitch - rows.length) * typeSize);
+    }
+  }
   return SUCCESS;
 }
 
@@ -90,6 +355,7 @@ int AllocateMemory(PimBo *bo, void *user_ptr) {
 
 PimBo *PimCreateBo(int w, int h, int c, int n, PimPrecision precision,
                    PimMemType mem_type, void *user_ptr) {
+  ApiCall call(ApiFunction::CREATE_BO);
   PimBShape shape{static_cast<uint32_t>(w), static_cast<uint32_t>(h),
                   static_cast<uint32_t>(c), static_cast<uint32_t>(n), false};
 
@@ -102,15 +368,56 @@ PimBo *PimCreateBo(int w, int h, int c, int n, PimPrecision precision,
   if (failed) {
     return nullptr;
   }
+  call.SetBuffer(bo.get());
   return bo.release();
 }
 
-PimBo *PimCreateBo(PimDesc *pim_desc, PimMemType mem_type, PimMemFlag,
-                   void *user_ptr) {
-  // We currently do not use the additional information from PimDesc or
-  // PimMemFlag for alignment etc.
-  auto bo = std::unique_ptr<PimBo>(new PimBo{
-      mem_type, pim_desc->bshape, pim_desc->bshape_r, pim_desc->precision});
+namespace {
+
+// Returns the shape of a buffer for 'mem_flag' described by the shape 'desc'
+// of a descriptor. A GEMV descriptor (W, H, C, N) describes the GEMV of N
+// vectors of length W with a H x W matrix, see ExecuteGemv for the layout.
+// GEMV_WEIGHT_T buffers have the same shape as GEMV_WEIGHT buffers, but the
+// 't' flag is set and the matrix is stored column-major, i.e., as the W x H
+// matrix transposed.
+PimBShape ShapeForFlag(PimBShape desc, PimMemFlag mem_flag) {
+  switch (mem_flag) {
+  case GEMV_INPUT:
+    return PimBShape{desc.w, 1, desc.c, desc.n, false};
+  case GEMV_WEIGHT:
+    return PimBShape{desc.w, desc.h, desc.c, 1, false};
+  case GEMV_WEIGHT_T:
+    return PimBShape{desc.w, desc.h, desc.c, 1, true};
+  case GEMV_OUTPUT:
+    return PimBShape{desc.h, 1, desc.c, desc.n, false};
+  case ELT_OP:
+  default:
+    return desc;
+  }
+}
+
+// Returns the storage shape of a buffer for 'mem_flag', i.e., its shape with
+// the rows padded as in the bshape_r of the descriptor, see PimCreateDesc.
+PimBShape StorageShapeForFlag(const PimDesc *desc, PimMemFlag mem_flag) {
+  PimBShape shape = ShapeForFlag(desc->bshape, mem_flag);
+  PimBShape padded = ShapeForFlag(desc->bshape_r, mem_flag);
+  if (shape.t) {
+    shape.h = std::max(shape.h, padded.h);
+  } else {
+    shape.w = std::max(shape.w, padded.w);
+  }
+  return shape;
+}
+
+} // anonymous namespace
+
+PimBo *PimCreateBo(PimDesc *pim_desc, PimMemType mem_type,
+                   PimMemFlag mem_flag, void *user_ptr) {
+  ApiCall call(ApiFunction::CREATE_BO);
+  auto bo = std::unique_ptr<PimBo>(
+      new PimBo{mem_type, ShapeForFlag(pim_desc->bshape, mem_flag),
+                StorageShapeForFlag(pim_desc, mem_flag),
+                pim_desc->precision});
   if (!bo) {
     return nullptr;
   }
@@ -118,12 +425,15 @@ PimBo *PimCreateBo(PimDesc *pim_desc, PimMemType mem_type, PimMemFlag,
   if (failed) {
     return nullptr;
   }
+  call.SetBuffer(bo.get());
   return bo.release();
 }
 
 int PimDestroyBo(PimBo *pim_bo) {
+  ApiCall call(ApiFunction::DESTROY_BO);
+  call.SetBuffer(pim_bo);
   if (!pim_bo->use_user_ptr && pim_bo->data) {
-    free(pim_bo->data);
+    FreeMemory(pim_bo);
   }
   delete pim_bo;
   return SUCCESS;
@@ -131,10 +441,20 @@ int PimDestroyBo(PimBo *pim_bo) {
 
 PimDesc *PimCreateDesc(int n, int c, int h, int w, PimPrecision precision,
                        PimOpType op_type) {
+  ApiCall call(ApiFunction::CREATE_DESC);
   PimBShape shape{static_cast<uint32_t>(w), static_cast<uint32_t>(h),
                   static_cast<uint32_t>(c), static_cast<uint32_t>(n), false};
+  // The rows of the buffers are padded to whole multiples of the buffer
+  // alignment, so that every row starts aligned and the kernels process
+  // whole vectors. The rows of GEMV outputs and of transposed GEMV weights
+  // run along h.
+  PimBShape padded = shape;
+  padded.w = PadRow(shape.w, ElementSize(precision));
+  if (op_type == OP_GEMV) {
+    padded.h = PadRow(shape.h, ElementSize(precision));
+  }
   auto desc =
-      std::unique_ptr<PimDesc>(new PimDesc{shape, shape, precision, op_type});
+      std::unique_ptr<PimDesc>(new PimDesc{shape, padded, precision, op_type});
   if (!desc) {
     return nullptr;
   }
@@ -142,12 +462,16 @@ PimDesc *PimCreateDesc(int n, int c, int h, int w, PimPrecision precision,
 }
 
 int PimDestroyDesc(PimDesc *pim_desc) {
+  ApiCall call(ApiFunction::DESTROY_DESC);
   delete pim_desc;
   return SUCCESS;
 }
 
-int PimAllocMemory(void **ptr, size_t size, PimMemType) {
-  *ptr = malloc(size);
+int PimAllocMemory(void **ptr, size_t size, PimMemType mem_type) {
+  ApiCall call(ApiFunction::ALLOC_MEMORY);
+  DeviceContext &device = CurrentDevice();
+  *ptr = device.Memory().Allocate(size, UseHugePages(mem_type),
+                                  DeviceNumaNode(device.Id()));
   if (!*ptr) {
     return ALLOC_ERROR;
   }
@@ -155,46 +479,218 @@ int PimAllocMemory(void **ptr, size_t size, PimMemType) {
 }
 
 int PimAllocMemory(PimBo *pim_bo) {
+  ApiCall call(ApiFunction::ALLOC_MEMORY);
+  call.SetBuffer(pim_bo);
   if (!pim_bo->use_user_ptr && pim_bo->data) {
     // Free the old memory before overriding it with a new allocation.
-    free(pim_bo->data);
+    FreeMemory(pim_bo);
   }
   return AllocateMemory(pim_bo, nullptr);
 }
 
 int PimFreeMemory(void *ptr, PimMemType) {
-  free(ptr);
+  ApiCall call(ApiFunction::FREE_MEMORY);
+  WaitForOperations();
+  if (!FreeDeviceMemory(ptr)) {
+    return ALLOC_ERROR;
+  }
   return SUCCESS;
 }
 
 int PimFreeMemory(PimBo *pim_bo) {
+  ApiCall call(ApiFunction::FREE_MEMORY);
+  call.SetBuffer(pim_bo);
   if (!pim_bo->use_user_ptr && pim_bo->data) {
-    free(pim_bo->data);
+    FreeMemory(pim_bo);
     pim_bo->data = nullptr;
     pim_bo->size = 0;
   }
   return SUCCESS;
 }
 
-int PimCopyMemory(void *dst, void *src, size_t size, PimMemCpyType) {
+namespace {
+
+// Runs 'op' on the stream 'stream' of the current device, or adds it to the
+// graph the stream is capturing, see PimBeginCapture. Non-blocking
+// operations are enqueued and run later, so 'op' captures the buffers by
+// value and only their memory has to stay valid, which frees ensure, see
+// WaitForOperations. Invalid operands are rejected before launching.
+// Non-blocking element-wise operations are deferred in deferred execution
+// mode, see PimSetDeferredExecution. Blocking operations of the default
+// stream run after the operations of all streams of the device. If tracing,
+// non-blocking operations are traced on the lane of the stream under the
+// name of the issuing call. Once the machine peaks were probed, the
+// executions are counted for the roofline, see CountExecution, except for
+// fused element-wise operations.
+int Launch(void *stream, bool block, Operation op) {
+  std::shared_ptr<Stream> target = CurrentDevice().GetStream(stream);
+  const ApiCall *call = CurrentApiCall();
+  bool trace = !block && TracingEnabled();
+  bool count = RooflineEnabled();
+  if (call && (trace || count)) {
+    op.run = [function = call->Function(), args = call->Args(), trace, count,
+              run = std::move(op.run)] {
+      TraceClock::time_point begin = TraceClock::now();
+      run();
+      TraceClock::time_point end = TraceClock::now();
+      if (trace) {
+        TraceSpan(ApiFunctionName(function), begin, end, args);
+      }
+      if (count) {
+        CountExecution(function,
+                       std::chrono::duration_cast<std::chrono::nanoseconds>(
+                           end - begin)
+                           .count(),
+                       args);
+      }
+    };
+  }
+  if (Graph *graph = target->Capturing()) {
+    graph->Add(std::move(op));
+    return SUCCESS;
+  }
+  if (!block && op.IsElementwise() &&
+      deferredExecution.load(std::memory_order_relaxed)) {
+    target->Defer(std::move(op));
+    return SUCCESS;
+  }
+  if (block && !stream) {
+    // Like the legacy default stream of HIP.
+    CurrentDevice().SynchronizeStreams();
+  }
+  target->Submit(std::move(op.run), block);
+  return SUCCESS;
+}
+
+bool IsCapturing(void *stream) {
+  return CurrentDevice().GetStream(stream)->Capturing() != nullptr;
+}
+
+// Executes 'copy' on the calling thread, distributed across the thread pool.
+void RunCopy(const RowCopy &copy) {
+  if (copy.numRows == 1) {
+    ParallelFor(copy.rowBytes, COPY_GRAIN, ELT_ALIGN,
+                [&](size_t begin, size_t end) {
+                  std::memcpy(copy.dst + begin, copy.src + begin,
+                              end - begin);
+                });
+    return;
+  }
+  size_t rowGrain = COPY_GRAIN / std::max<size_t>(copy.rowBytes, 1);
+  ParallelFor(copy.numRows, rowGrain,
+              [&](size_t begin, size_t end) { copy.Run(begin, end); });
+}
+
+// Executes 'copy' on the calling thread after all operations of the current
+// device and of the devices of the buffers 'bos' if 'block' is set, like
+// hipMemcpy. Otherwise, enqueues it on the stream 'stream' of the current
+// device, whose copy engine executes it, like hipMemcpyAsync. Copies issued
+// to a capturing stream are captured either way. Blocking copies are counted
+// for the roofline like the operations of Launch.
+int IssueCopy(const RowCopy &copy, std::initializer_list<const PimBo *> bos,
+              void *stream, bool block) {
+  bool capturing = IsCapturing(stream);
+  if (block && !capturing) {
+    WaitForOperations(bos);
+    TraceClock::time_point begin = TraceClock::now();
+    RunCopy(copy);
+    const ApiCall *call = CurrentApiCall();
+    if (call && RooflineEnabled()) {
+      CountExecution(call->Function(),
+                     std::chrono::duration_cast<std::chrono::nanoseconds>(
+                         TraceClock::now() - begin)
+                         .count(),
+                     call->Args());
+    }
+    return SUCCESS;
+  }
+  CopyEngine &engine = CurrentDevice().Copies();
+  if (capturing) {
+    // Captured copies are issued whenever the graph runs.
+    return Launch(stream, block, {[&engine, copy] {
+                    engine.Issue(copy.Bytes());
+                    engine.Execute(copy);
+                  }});
+  }
+  engine.Issue(copy.Bytes());
+  return Launch(stream, false, {[&engine, copy] { engine.Execute(copy); }});
+}
+
+bool SamePrecision(const PimBo *bo0, const PimBo *bo1) {
+  return bo0->precision == bo1->precision;
+}
+
+bool IsRaw(const PimBo *bo) { return bo->data_layout == PIM_LAYOUT_RAW; }
+
+// Whether the raw buffers have the same number of rows of the same length,
+// see StorageRows, i.e., hold the same elements up to the row padding.
+bool SameRows(const PimBo *bo0, const PimBo *bo1) {
+  StorageRows rows0 = GetStorageRows(bo0);
+  StorageRows rows1 = GetStorageRows(bo1);
+  return rows0.count == rows1.count && rows0.length == rows1.length;
+}
+
+// Whether the raw buffers store their elements at the same offsets, so that
+// they can be processed as flat arrays. Packed buffers of the same size
+// qualify regardless of their shapes.
+bool SameStorage(const PimBo *bo0, const PimBo *bo1) {
+  if (bo0->size != bo1->size) {
+    return false;
+  }
+  if (IsPacked(bo0) && IsPacked(bo1)) {
+    return true;
+  }
+  return SameRows(bo0, bo1) &&
+         GetStorageRows(bo0).pitch == GetStorageRows(bo1).pitch;
+}
+
+// The copies of PimCopyMemory and PimCopyMemoryRect, issued as by IssueCopy
+// and measured by 'call'.
+int CopyMemory(ApiCall &call, void *dst, void *src, size_t size,
+               void *stream, bool block) {
   if (!dst || !src || !size) {
     return COPY_ERROR;
   }
-  std::memcpy(dst, src, size);
-  return SUCCESS;
+  call.SetTraffic(size, size, 0);
+  return IssueCopy({static_cast<char *>(dst), static_cast<const char *>(src),
+                    size},
+                   {}, stream, block);
 }
 
-int PimCopyMemory(PimBo *dst, PimBo *src, PimMemCpyType) {
-  if (!dst->data || !src->data || !src->size || src->size != dst->size) {
+int CopyMemory(ApiCall &call, PimBo *dst, PimBo *src, void *stream,
+               bool block) {
+  call.SetBuffer(dst);
+  if (!dst->data || !src->data || !src->size ||
+      dst->data_layout != src->data_layout) {
     return COPY_ERROR;
   }
   // FIXME(Lukas): We could use the PimMemType of the buffer objects to verify
   // that PimMemCpyType is actually applicable to the two buffers.
-  std::memcpy(dst->data, src->data, src->size);
-  return SUCCESS;
+  RowCopy copy{static_cast<char *>(dst->data),
+               static_cast<const char *>(src->data), src->size};
+  if (src->size != dst->size || (IsRaw(src) && !SameStorage(dst, src))) {
+    // Buffers holding the same elements with different row padding, e.g., a
+    // buffer created from a descriptor and a packed one, are copied row by
+    // row.
+    if (!IsRaw(src) || !SamePrecision(dst, src) || !SameRows(dst, src)) {
+      return COPY_ERROR;
+    }
+    size_t elementSize = PrecisionSize(src);
+    StorageRows dstRows = GetStorageRows(dst);
+    StorageRows srcRows = GetStorageRows(src);
+    copy.rowBytes = srcRows.length * elementSize;
+    copy.numRows = copy.height = srcRows.count;
+    copy.dstPitch = dstRows.pitch * elementSize;
+    copy.srcPitch = srcRows.pitch * elementSize;
+  }
+  call.SetTraffic(copy.Bytes(), copy.Bytes(),
+                  copy.Bytes() / PrecisionSize(src));
+  return IssueCopy(copy, {dst, src}, stream, block);
 }
 
-int PimCopyMemoryRect(const PimCopy3D *params) {
+int CopyMemoryRect(ApiCall &call, const PimCopy3D *params, void *stream,
+                   bool block) {
+  call.SetBuffer(params->dst_bo ? params->dst_bo : params->src_bo);
   if (!params->src_ptr && !params->src_bo) {
     // One of srcPtr and srcBo must be given
     return COPY_ERROR;
@@ -203,6 +699,11 @@ int PimCopyMemoryRect(const PimCopy3D *params) {
     // One of dstPtr and dstBo must be given
     return COPY_ERROR;
   }
+  if ((params->src_bo && params->src_bo->data_layout != PIM_LAYOUT_RAW) ||
+      (params->dst_bo && params->dst_bo->data_layout != PIM_LAYOUT_RAW)) {
+    // Slices of blocked buffers are not rectangular.
+    return COPY_ERROR;
+  }
 
   const void *src = nullptr;
   size_t sPitch = 0;
@@ -210,8 +711,8 @@ int PimCopyMemoryRect(const PimCopy3D *params) {
   if (params->src_bo != nullptr) {
     auto *bo = params->src_bo;
     src = bo->data;
-    sPitch = bo->bshape.w * PrecisionSize(bo);
-    sHeight = bo->bshape.h;
+    sPitch = GetStorageRows(bo).pitch * PrecisionSize(bo);
+    sHeight = bo->bshape.t ? bo->bshape.w : bo->bshape.h;
   } else {
     src = params->src_ptr;
     sPitch = params->src_pitch;
@@ -233,8 +734,8 @@ int PimCopyMemoryRect(const PimCopy3D *params) {
   if (params->dst_bo != nullptr) {
     auto *bo = params->dst_bo;
     dst = bo->data;
-    dPitch = bo->bshape.w * PrecisionSize(bo);
-    dHeight = bo->bshape.h;
+    dPitch = GetStorageRows(bo).pitch * PrecisionSize(bo);
+    dHeight = bo->bshape.t ? bo->bshape.w : bo->bshape.h;
   } else {
     dst = params->dst_ptr;
     dPitch = params->dst_pitch;
@@ -250,112 +751,384 @@ int PimCopyMemoryRect(const PimCopy3D *params) {
                             params->dst_x_in_bytes);
 
   // Host emulation does not have a rectangular copy, so perform the rectangular
-  // copy as a series of row-wise copies.
-  for (size_t d = 0; d < params->depth; ++d) {
-    for (size_t h = 0; h < params->height; ++h) {
-      size_t sOffset = (d * sHeight + h) * sPitch;
-      const void *tmpSrc =
-          static_cast<const void *>(static_cast<const char *>(src) + sOffset);
-      size_t dOffset = (d * dHeight + h) * dPitch;
-      void *tmpDst = static_cast<void *>(static_cast<char *>(dst) + dOffset);
-      std::memcpy(tmpDst, tmpSrc, params->width_in_bytes);
-    }
+  // copy as a series of row-wise copies. Row h of slice d starts at
+  // (d * height + h) * pitch.
+  if (!params->height) {
+    return SUCCESS;
   }
-  return SUCCESS;
+  RowCopy copy{static_cast<char *>(dst), static_cast<const char *>(src),
+               params->width_in_bytes};
+  copy.numRows = params->depth * params->height;
+  copy.height = params->height;
+  copy.dstPitch = dPitch;
+  copy.srcPitch = sPitch;
+  copy.dstPlanePitch = dHeight * dPitch;
+  copy.srcPlanePitch = sHeight * sPitch;
+  call.SetTraffic(copy.Bytes(), copy.Bytes(), 0);
+  return IssueCopy(copy, {params->src_bo, params->dst_bo}, stream, block);
+}
+
+} // anonymous namespace
+
+// The asynchronous variants of pim_mock_api.h are measured as their
+// synchronous functions.
+
+int PimCopyMemory(void *dst, void *src, size_t size, PimMemCpyType) {
+  ApiCall call(ApiFunction::COPY_MEMORY);
+  return CopyMemory(call, dst, src, size, nullptr, true);
+}
+
+int PimCopyMemoryAsync(void *dst, void *src, size_t size, PimMemCpyType,
+                       void *stream) {
+  ApiCall call(ApiFunction::COPY_MEMORY);
+  return CopyMemory(call, dst, src, size, stream, false);
+}
+
+int PimCopyMemory(PimBo *dst, PimBo *src, PimMemCpyType) {
+  ApiCall call(ApiFunction::COPY_MEMORY);
+  return CopyMemory(call, dst, src, nullptr, true);
+}
+
+int PimCopyMemoryAsync(PimBo *dst, PimBo *src, PimMemCpyType, void *stream) {
+  ApiCall call(ApiFunction::COPY_MEMORY);
+  return CopyMemory(call, dst, src, stream, false);
 }
 
+int PimCopyMemoryRect(const PimCopy3D *params) {
+  ApiCall call(ApiFunction::COPY_MEMORY_RECT);
+  return CopyMemoryRect(call, params, nullptr, true);
+}
+
+int PimCopyMemoryRectAsync(const PimCopy3D *params, void *stream) {
+  ApiCall call(ApiFunction::COPY_MEMORY_RECT);
+  return CopyMemoryRect(call, params, stream, false);
+}
+
+// Returns the number of elements stored in the buffer, including the row
+// padding.
 size_t NumElements(const PimBo *bo) {
   assert(bo != nullptr && "Invalid buffer");
-  auto bshape = bo->bshape;
-  size_t numElements = bshape.n * bshape.c * bshape.h * bshape.w;
-  assert(numElements * PrecisionSize(bo) == bo->size);
-  return numElements;
+  return bo->size / PrecisionSize(bo);
 }
 
-int PimExecuteAdd(PimBo *output, PimBo *input1, PimBo *input2, void *, bool) {
-  // FIXME(Lukas): We ignore the non-blocking mode. We could implement
-  // asynchronous/non-blocking operation in the future.
-  if (!output->data || !input1->data || !input2->data ||
-      input1->size != input2->size || input1->size != output->size) {
+namespace {
+
+// Returns the element-wise operation calling 'fn(offsets, count)' for
+// segments of 'count' elements of the raw buffers 'bos', at the element
+// offsets 'offsets' into the buffers, distributed across the thread pool. If
+// all buffers have the same storage, see SameStorage, the segments cover the
+// whole storage, including the row padding, so the kernels run on whole
+// vectors, and the operation can be fused, see Operation. Otherwise, the
+// buffers must have the same rows and the segments are single rows. The
+// layout is resolved when the operation is issued.
+template <size_t N, typename Fn>
+Operation ElementwiseOperation(const std::array<const PimBo *, N> &bos,
+                               Fn fn) {
+  static_assert(N <= std::tuple_size<decltype(Operation::buffers)>::value,
+                "Too many buffers");
+  bool sameStorage = true;
+  for (const PimBo *bo : bos) {
+    sameStorage = sameStorage && SameStorage(bos[0], bo);
+  }
+  Operation op;
+  if (sameStorage) {
+    op.runRange = [fn](size_t begin, size_t end) {
+      std::array<size_t, N> offsets;
+      offsets.fill(begin);
+      fn(offsets, end - begin);
+    };
+    op.numElements = NumElements(bos[0]);
+    op.elementSize = PrecisionSize(bos[0]);
+    op.grain = ELT_GRAIN;
+    op.align = ELT_ALIGN;
+    for (size_t i = 0; i < N; ++i) {
+      op.buffers[i] = {static_cast<const char *>(bos[i]->data), bos[i]->size};
+    }
+    op.run = [runRange = op.runRange, count = op.numElements] {
+      ParallelFor(count, ELT_GRAIN, ELT_ALIGN, runRange);
+    };
+    return op;
+  }
+  std::array<size_t, N> pitches;
+  for (size_t i = 0; i < N; ++i) {
+    pitches[i] = GetStorageRows(bos[i]).pitch;
+  }
+  StorageRows rows = GetStorageRows(bos[0]);
+  op.run = [fn, pitches, rows] {
+    size_t rowGrain = ELT_GRAIN / std::max<size_t>(rows.length, 1);
+    ParallelFor(rows.count, rowGrain, [&](size_t begin, size_t end) {
+      for (size_t row = begin; row < end; ++row) {
+        std::array<size_t, N> offsets;
+        for (size_t i = 0; i < N; ++i) {
+          offsets[i] = row * pitches[i];
+        }
+        fn(offsets, rows.length);
+      }
+    });
+  };
+  return op;
+}
+
+// Runs the element-wise 'kernel' of the element type T on the thread pool.
+template <typename T>
+int ExecuteBinary(void (*kernel)(T *, const T *, const T *, size_t),
+                  const PimBo &output, const PimBo &input1,
+                  const PimBo &input2, void *stream, bool block) {
+  T *out = static_cast<T *>(output.data);
+  const T *in1 = static_cast<const T *>(input1.data);
+  const T *in2 = static_cast<const T *>(input2.data);
+  return Launch(stream, block,
+                ElementwiseOperation<3>(
+                    {&output, &input1, &input2},
+                    [=](const std::array<size_t, 3> &offsets, size_t count) {
+                      kernel(out + offsets[0], in1 + offsets[1],
+                             in2 + offsets[2], count);
+                    }));
+}
+
+template <typename T>
+int ExecuteUnary(void (*kernel)(T *, const T *, size_t), const PimBo &output,
+                 const PimBo &input, void *stream, bool block) {
+  T *out = static_cast<T *>(output.data);
+  const T *in = static_cast<const T *>(input.data);
+  return Launch(stream, block,
+                ElementwiseOperation<2>(
+                    {&output, &input},
+                    [=](const std::array<size_t, 2> &offsets, size_t count) {
+                      kernel(out + offsets[0], in + offsets[1], count);
+                    }));
+}
+
+// The scalar is read when the operation is issued.
+template <typename T>
+int ExecuteScalar(void (*kernel)(T *, const T *, T, size_t),
+                  const PimBo &output, const void *scalar,
+                  const PimBo &vector, void *stream, bool block) {
+  T value = *static_cast<const T *>(scalar);
+  T *out = static_cast<T *>(output.data);
+  const T *vec = static_cast<const T *>(vector.data);
+  return Launch(stream, block,
+                ElementwiseOperation<2>(
+                    {&output, &vector},
+                    [=](const std::array<size_t, 2> &offsets, size_t count) {
+                      kernel(out + offsets[0], vec + offsets[1], value,
+                             count);
+                    }));
+}
+
+// Element-wise operands are raw buffers of the precision of the output, which
+// either all have the same storage as the output, or all hold the same rows
+// as the output with any row padding, see ElementwiseOperation.
+bool CompatibleOperands(const PimBo *output,
+                        std::initializer_list<const PimBo *> inputs) {
+  if (!output->data || !IsRaw(output)) {
+    return false;
+  }
+  bool sameStorage = true;
+  bool sameRows = true;
+  for (const PimBo *input : inputs) {
+    if (!input->data || !SamePrecision(output, input) || !IsRaw(input)) {
+      return false;
+    }
+    sameStorage = sameStorage && SameStorage(output, input);
+    sameRows = sameRows && SameRows(output, input);
+  }
+  return sameStorage || sameRows;
+}
+
+bool ValidBinaryOperands(PimBo *output, PimBo *input1, PimBo *input2) {
+  return CompatibleOperands(output, {input1, input2});
+}
+
+bool ValidScalarOperands(PimBo *output, void *scalar, PimBo *vector) {
+  return scalar && CompatibleOperands(output, {vector});
+}
+
+} // anonymous namespace
+
+// The scalar of the scalar variants is of the precision of the buffers, i.e.,
+// a half_t for PIM_FP16 and an int8_t for PIM_INT8. INT8 arithmetic saturates.
+// Operations with 'block' unset run asynchronously on the stream 'stream' of
+// the current device, see Launch, and PimSynchronize waits for them.
+
+int PimExecuteAdd(PimBo *output, PimBo *input1, PimBo *input2, void *stream,
+                  bool block) {
+  ApiCall call(ApiFunction::EXECUTE_ADD);
+  call.SetBuffer(output);
+  if (!ValidBinaryOperands(output, input1, input2)) {
     return OPERATION_ERROR;
   }
-  half_t *halfOut = static_cast<half_t *>(output->data);
-  half_t *halfIn1 = static_cast<half_t *>(input1->data);
-  half_t *halfIn2 = static_cast<half_t *>(input2->data);
-  for (size_t i = 0; i < NumElements(output); ++i) {
-    halfOut[i] = halfIn1[i] + halfIn2[i];
+  call.SetTraffic(input1->size + input2->size, output->size,
+                  NumElements(output));
+  const auto &table = kernels::GetKernels();
+  if (output->precision == PIM_INT8) {
+    return ExecuteBinary(table.addInt8, *output, *input1, *input2, stream,
+                         block);
   }
-  return SUCCESS;
+  return ExecuteBinary(table.add, *output, *input1, *input2, stream, block);
 }
 
-int PimExecuteAdd(PimBo *output, void *scalar, PimBo *vector, void *, bool) {
-  // FIXME(Lukas): We ignore the non-blocking mode. We could implement
-  // asynchronous/non-blocking operation in the future.
-  if (!output->data || !vector->data || !scalar ||
-      vector->size != output->size) {
+int PimExecuteAdd(PimBo *output, void *scalar, PimBo *vector, void *stream,
+                  bool block) {
+  ApiCall call(ApiFunction::EXECUTE_ADD);
+  call.SetBuffer(output);
+  if (!ValidScalarOperands(output, scalar, vector)) {
     return OPERATION_ERROR;
   }
-  half_t *halfOut = static_cast<half_t *>(output->data);
-  half_t *halfVec = static_cast<half_t *>(vector->data);
-  half_t halfScalar = *static_cast<half_t *>(scalar);
-  for (size_t i = 0; i < NumElements(output); ++i) {
-    halfOut[i] = halfVec[i] + halfScalar;
+  call.SetTraffic(vector->size, output->size, NumElements(output));
+  const auto &table = kernels::GetKernels();
+  if (output->precision == PIM_INT8) {
+    return ExecuteScalar(table.addScalarInt8, *output, scalar, *vector,
+                         stream, block);
   }
-  return SUCCESS;
+  return ExecuteScalar(table.addScalar, *output, scalar, *vector, stream,
+                       block);
 }
 
-int PimExecuteMul(PimBo *output, PimBo *input1, PimBo *input2, void *, bool) {
-  // FIXME(Lukas): We ignore the non-blocking mode. We could implement
-  // asynchronous/non-blocking operation in the future.
-  if (!output->data || !input1->data || !input2->data ||
-      input1->size != input2->size || input1->size != output->size) {
+int PimExecuteMul(PimBo *output, PimBo *input1, PimBo *input2, void *stream,
+                  bool block) {
+  ApiCall call(ApiFunction::EXECUTE_MUL);
+  call.SetBuffer(output);
+  if (!ValidBinaryOperands(output, input1, input2)) {
     return OPERATION_ERROR;
   }
-  half_t *halfOut = static_cast<half_t *>(output->data);
-  half_t *halfIn1 = static_cast<half_t *>(input1->data);
-  half_t *halfIn2 = static_cast<half_t *>(input2->data);
-  for (size_t i = 0; i < NumElements(output); ++i) {
-    halfOut[i] = halfIn1[i] * halfIn2[i];
+  call.SetTraffic(input1->size + input2->size, output->size,
+                  NumElements(output));
+  const auto &table = kernels::GetKernels();
+  if (output->precision == PIM_INT8) {
+    return ExecuteBinary(table.mulInt8, *output, *input1, *input2, stream,
+                         block);
   }
-  return SUCCESS;
+  return ExecuteBinary(table.mul, *output, *input1, *input2, stream, block);
 }
 
-int PimExecuteMul(PimBo *output, void *scalar, PimBo *vector, void *, bool) {
-  // FIXME(Lukas): We ignore the non-blocking mode. We could implement
-  // asynchronous/non-blocking operation in the future.
-  if (!output->data || !vector->data || !scalar ||
-      vector->size != output->size) {
+int PimExecuteMul(PimBo *output, void *scalar, PimBo *vector, void *stream,
+                  bool block) {
+  ApiCall call(ApiFunction::EXECUTE_MUL);
+  call.SetBuffer(output);
+  if (!ValidScalarOperands(output, scalar, vector)) {
     return OPERATION_ERROR;
   }
-  half_t *halfOut = static_cast<half_t *>(output->data);
-  half_t *halfVec = static_cast<half_t *>(vector->data);
-  half_t halfScalar = *static_cast<half_t *>(scalar);
-  for (size_t i = 0; i < NumElements(output); ++i) {
-    halfOut[i] = halfVec[i] * halfScalar;
+  call.SetTraffic(vector->size, output->size, NumElements(output));
+  const auto &table = kernels::GetKernels();
+  if (output->precision == PIM_INT8) {
+    return ExecuteScalar(table.mulScalarInt8, *output, scalar, *vector,
+                         stream, block);
   }
-  return SUCCESS;
+  return ExecuteScalar(table.mulScalar, *output, scalar, *vector, stream,
+                       block);
 }
 
-int PimExecuteRelu(PimBo *output, PimBo *pim_data, void *, bool) {
-  // FIXME(Lukas): We ignore the non-blocking mode. We could implement
-  // asynchronous/non-blocking operation in the future.
-  if (!output->data || !pim_data->data || pim_data->size != output->size) {
+int PimExecuteRelu(PimBo *output, PimBo *pim_data, void *stream, bool block) {
+  ApiCall call(ApiFunction::EXECUTE_RELU);
+  call.SetBuffer(output);
+  if (!CompatibleOperands(output, {pim_data})) {
     return OPERATION_ERROR;
   }
-  half_t *halfOut = static_cast<half_t *>(output->data);
-  half_t *halfData = static_cast<half_t *>(pim_data->data);
-  for (size_t i = 0; i < NumElements(output); ++i) {
-    halfOut[i] = (half_float::signbit(halfData[i])) ? 0.0 : halfData[i];
+  call.SetTraffic(pim_data->size, output->size, NumElements(output));
+  const auto &table = kernels::GetKernels();
+  if (output->precision == PIM_INT8) {
+    return ExecuteUnary(table.reluInt8, *output, *pim_data, stream, block);
   }
-  return SUCCESS;
+  return ExecuteUnary(table.relu, *output, *pim_data, stream, block);
 }
 
-int PimExecuteGemv(PimBo *output, PimBo *operand0, PimBo *operand1, void *,
-                   bool) {
-  // FIXME(Lukas): We ignore the non-blocking mode. We could implement
-  // asynchronous/non-blocking operation in the future.
+namespace {
+
+// Runs the blocked GEMV kernel of the element type T on the thread pool, see
+// ExecuteGemv.
+template <typename T>
+void RunGemv(const PimBo *output, const PimBo *operand0,
+             const PimBo *operand1, const PimBo *addend, bool relu) {
+  T *out = static_cast<T *>(output->data);
+  const T *vec = static_cast<const T *>(operand0->data);
+  const T *mat = static_cast<const T *>(operand1->data);
+  // The vectors and the outputs of channel c start at row c, the rows are
+  // possibly padded, see StorageRows.
+  size_t inPitch = GetStorageRows(operand0).pitch;
+  size_t outPitch = GetStorageRows(output).pitch;
+  kernels::GemvEpilogue<T> epilogue;
+  size_t addendPitch = 0;
+  if (addend) {
+    epilogue.addend = static_cast<const T *>(addend->data);
+    addendPitch = GetStorageRows(addend).pitch;
+    epilogue.addendStride = output->bshape.c * addendPitch;
+  }
+  epilogue.relu = relu;
+
+  // Every output element (n, c, w) is computed by exactly one thread, so the
+  // result does not depend on the number of threads. The panels of
+  // GEMV_ROW_TILE rows of all channels are split across the threads, each
+  // thread calls the blocked GEMV kernel for the part of its range belonging
+  // to the same channel, for all N vectors at once, so every weight tile is
+  // read once per batch. Splitting at panels keeps the ranges aligned to the
+  // tiles of weights in the blocked layout.
+  size_t numOut = output->bshape.w;
+  size_t numIn = operand0->bshape.w;
+  size_t numVecs = output->bshape.n;
+  constexpr size_t panelRows = kernels::GEMV_ROW_TILE;
+  size_t numPanels = (numOut + panelRows - 1) / panelRows;
+  size_t panelGrain =
+      GEMV_GRAIN / std::max<size_t>(numIn * numVecs * panelRows, 1);
+  // Row-major weights and weights in the blocked layout start the panels of
+  // channel c at row c * numOut + w, while transposed weights have numIn
+  // rows of numOut elements per channel.
+  kernels::GemvLayout layout = kernels::GemvLayout::ROW_MAJOR;
+  size_t ld = GetStorageRows(operand1).pitch;
+  if (operand1->data_layout == PIM_LAYOUT_GEMV_BLOCKED) {
+    layout = kernels::GemvLayout::BLOCKED;
+    ld = kernels::BlockedGemvLd(numIn, sizeof(T));
+  } else if (operand1->bshape.t) {
+    layout = kernels::GemvLayout::TRANSPOSED;
+  }
+  // From the test examples, it looks as if the matrix doesn't have n != 1,
+  // but the same weight matrix is used for all vectors in a batch.
+  size_t outStride = output->bshape.c * outPitch;
+  size_t vecStride = operand0->bshape.c * inPitch;
+  ParallelFor(
+      output->bshape.c * numPanels, panelGrain, [&](size_t begin, size_t end) {
+        while (begin < end) {
+          size_t c = begin / numPanels;
+          size_t panel = begin % numPanels;
+          size_t panels = std::min(numPanels - panel, end - begin);
+          size_t w = panel * panelRows;
+          size_t rows = std::min((panel + panels) * panelRows, numOut) - w;
+          size_t offsetMat = (layout == kernels::GemvLayout::TRANSPOSED)
+                                 ? c * numIn * ld + w
+                                 : (c * numOut + w) * ld;
+          kernels::GemvEpilogue<T> segment = epilogue;
+          if (segment.addend) {
+            segment.addend += c * addendPitch + w;
+          }
+          kernels::Gemv(out + c * outPitch + w, outStride, mat + offsetMat,
+                        ld, layout, vec + c * inPitch, vecStride, numVecs,
+                        rows, numIn, segment);
+          begin += panels;
+        }
+      });
+}
+
+// Computes 'output = GEMV(operand0, operand1) + addend', followed by ReLU if
+// 'relu' is set. 'addend' is optional, has the same shape as 'output' and
+// may be 'output' itself. FP16 GEMV accumulates in FP32, INT8 GEMV in INT32
+// and saturates the result. The traffic is counted by 'call', with the
+// multiply-adds as the elements.
+int ExecuteGemv(ApiCall &call, PimBo *output, PimBo *operand0,
+                PimBo *operand1, const PimBo *addend, bool relu, void *stream,
+                bool block) {
+  call.SetBuffer(output);
   PimBo *op2 = (operand1) ? operand1 : output;
-  if (!op2->data || !operand0->data) {
+  if (!output->data || !op2->data || !operand0->data) {
+    return OPERATION_ERROR;
+  }
+  if (!SamePrecision(output, operand0) || !SamePrecision(output, op2)) {
+    return OPERATION_ERROR;
+  }
+  if (addend && !CompatibleOperands(output, {addend})) {
+    return OPERATION_ERROR;
+  }
+  // Only the weights may be in the blocked layout of PimConvertGemvWeight.
+  if (!IsRaw(output) || !IsRaw(operand0)) {
     return OPERATION_ERROR;
   }
 
@@ -364,6 +1137,8 @@ int PimExecuteGemv(PimBo *output, PimBo *operand0, PimBo *operand1, void *,
   // Operand0 (Vector): (X, 1, C, N)
   // Operand1 (Matrix): (X, Y, C, 1)
   // Output   (Result): (Y, 1, C, N)
+  // The matrix of each channel is stored row-major, or column-major if its
+  // 't' flag is set (GEMV_WEIGHT_T).
   if (op2->bshape.n != 1 || output->bshape.n != operand0->bshape.n ||
       op2->bshape.c != operand0->bshape.c ||
       output->bshape.c != operand0->bshape.c ||
@@ -378,79 +1153,169 @@ int PimExecuteGemv(PimBo *output, PimBo *operand0, PimBo *operand1, void *,
     return OPERATION_ERROR;
   }
 
-  half_t *out = static_cast<half_t *>(output->data);
-  half_t *vec = static_cast<half_t *>(operand0->data);
-  half_t *mat = static_cast<half_t *>(op2->data);
-
-  for (size_t n = 0; n < output->bshape.n; ++n) {
-    for (size_t c = 0; c < output->bshape.c; ++c) {
-      for (size_t h = 0; h < output->bshape.h; ++h) {
-        for (size_t w = 0; w < output->bshape.w; ++w) {
-          // From the test examples, it looks as if the matrix doesn't have n !=
-          // 1, but the same weight matrix is used for all vectors in a batch.
-          size_t offsetMat =
-              w * op2->bshape.w + c * op2->bshape.h * op2->bshape.w;
-          size_t offsetVec = c * operand0->bshape.w +
-                             n * operand0->bshape.c * operand0->bshape.w;
-          half_t acc;
-          for (size_t k = 0; k < operand0->bshape.w; ++k) {
-            acc += mat[offsetMat + k] * vec[offsetVec + k];
-          }
-          size_t offsetOut =
-              n * output->bshape.c * output->bshape.w + c * output->bshape.w;
-          out[offsetOut + w] = acc;
-        }
-      }
-    }
+  call.SetTraffic(operand0->size + op2->size + (addend ? addend->size : 0),
+                  output->size,
+                  uint64_t{output->bshape.w} * operand0->bshape.w *
+                      operand0->bshape.c * operand0->bshape.n);
+  bool hasAddend = addend != nullptr;
+  PimBo addendBo = hasAddend ? *addend : PimBo{};
+  return Launch(stream, block,
+                {[=, out = *output, vec = *operand0, mat = *op2] {
+                  const PimBo *add = hasAddend ? &addendBo : nullptr;
+                  if (out.precision == PIM_INT8) {
+                    RunGemv<int8_t>(&out, &vec, &mat, add, relu);
+                  } else {
+                    RunGemv<half_t>(&out, &vec, &mat, add, relu);
+                  }
+                }});
+}
+
+} // anonymous namespace
+
+PimBo *PimConvertGemvWeight(PimBo *weight) {
+  ApiCall call(ApiFunction::CONVERT_GEMV_WEIGHT);
+  call.SetBuffer(weight);
+  // The weights have the layout (X, Y, C, 1), see ExecuteGemv, and every
+  // channel is converted separately.
+  if (!weight || !weight->data || !IsRaw(weight) || weight->bshape.n != 1 ||
+      weight->bshape.h == 0 || weight->bshape.w == 0 ||
+      weight->bshape.c == 0) {
+    return nullptr;
   }
-  return SUCCESS;
+  size_t elementSize = PrecisionSize(weight);
+  size_t numIn = weight->bshape.w;
+  size_t numOut = weight->bshape.h;
+  size_t srcLd = GetStorageRows(weight).pitch;
+  size_t srcChannelSize =
+      (weight->bshape.t ? numIn : numOut) * srcLd * elementSize;
+  size_t channelSize =
+      numOut * kernels::BlockedGemvLd(numIn, elementSize) * elementSize;
+  size_t size = weight->bshape.c * channelSize;
+  WaitForOperations({weight});
+  // The tiles are aligned to cache lines, as are all blocks of the pool. The
+  // converted weights stay on the device of the weights.
+  void *data = GetDevice(weight->device_id)
+                   .Memory()
+                   .Allocate(size, UseHugePages(weight->mem_type),
+                             DeviceNumaNode(weight->device_id));
+  if (!data) {
+    return nullptr;
+  }
+  auto bo = std::unique_ptr<PimBo>(new PimBo(*weight));
+  bo->size = size;
+  bo->data = data;
+  bo->use_user_ptr = false;
+  bo->data_layout = PIM_LAYOUT_GEMV_BLOCKED;
+  // The blocked layout is the same for transposed weights and has its own
+  // padding.
+  bo->bshape.t = false;
+  bo->bshape_r = bo->bshape;
+  size_t channelGrain =
+      COPY_GRAIN / std::max<size_t>(numOut * numIn * elementSize, 1);
+  ParallelFor(weight->bshape.c, channelGrain, [&](size_t begin, size_t end) {
+    for (size_t c = begin; c < end; ++c) {
+      kernels::PackGemvWeights(
+          static_cast<char *>(bo->data) + c * channelSize,
+          static_cast<const char *>(weight->data) + c * srcChannelSize,
+          srcLd, numOut, numIn, elementSize, weight->bshape.t);
+    }
+  });
+  call.SetTraffic(weight->size, size, NumElements(weight));
+  return bo.release();
 }
 
-int PimExecuteGemvAdd(PimBo *output, PimBo *operand0, PimBo *operand1, void *,
-                      bool) {
-  // FIXME(Lukas): We ignore the non-blocking mode. We could implement
-  // asynchronous/non-blocking operation in the future.
+int PimExecuteGemv(PimBo *output, PimBo *operand0, PimBo *operand1,
+                   void *stream, bool block) {
+  ApiCall call(ApiFunction::EXECUTE_GEMV);
+  return ExecuteGemv(call, output, operand0, operand1, nullptr, false, stream,
+                     block);
+}
 
+int PimExecuteGemvAdd(PimBo *output, PimBo *operand0, PimBo *operand1,
+                      void *stream, bool block) {
+  ApiCall call(ApiFunction::EXECUTE_GEMV_ADD);
   // According to the documentation in the header, this is supposed to
-  // calculate 'output = output + GEMV(operand0, operand1)'.
-  // Create an intermediate buffer to hold the result of the GEMV operation.
-  PimBo temp{output->mem_type,
-             output->bshape,
-             output->bshape_r,
-             output->precision,
-             output->size,
-             nullptr,
-             false};
-  int failed = PimAllocMemory(&temp);
-  if (!failed) {
-    failed |= PimExecuteGemv(&temp, operand0, operand1);
-    failed |= PimExecuteAdd(output, output, &temp);
-  }
-  failed |= PimFreeMemory(&temp);
-  return failed;
+  // calculate 'output = output + GEMV(operand0, operand1)'. The addition is
+  // fused into the GEMV, which reads each output element before overwriting
+  // it, and the sum is rounded to FP16 (or saturated to INT8) once.
+  return ExecuteGemv(call, output, operand0, operand1, output, false, stream,
+                     block);
 }
 
 int PimExecuteGemvAdd(PimBo *output, PimBo *operand0, PimBo *operand1,
-                      PimBo *operand2, bool relu, void *, bool) {
-  // FIXME(Lukas): We ignore the non-blocking mode. We could implement
-  // asynchronous/non-blocking operation in the future.
-
+                      PimBo *operand2, bool relu, void *stream,
+                      bool block) {
+  ApiCall call(ApiFunction::EXECUTE_GEMV_ADD);
   // Guessing from the documentation in the header, this is supposed to
   // calculate 'output = operand2 + GEMV(operand0, operand1)' and potentially
-  // apply RELU to the output before returning.
-  int failed = PimExecuteGemv(output, operand0, operand1);
-  failed |= PimExecuteAdd(output, output, operand2);
-  if (relu) {
-    failed |= PimExecuteRelu(output, output);
+  // apply RELU to the output before returning. Both are fused into the GEMV
+  // and applied to the FP32 (or INT32) result before rounding.
+  if (!operand2) {
+    return OPERATION_ERROR;
   }
-  return failed;
+  return ExecuteGemv(call, output, operand0, operand1, operand2, relu, stream,
+                     block);
 }
 
-int PimExecuteBN(PimBo *output, PimBo *pim_data, PimBo *beta, PimBo *gamma,
-                 PimBo *mean, PimBo *variance, double epsilon, void *, bool) {
-  // FIXME(Lukas): We ignore the non-blocking mode. We could implement
-  // asynchronous/non-blocking operation in the future.
+int PimExecuteGemvList(PimBo *output, PimBo *vector, PimBo *matrix,
+                       void *stream, bool block) {
+  ApiCall call(ApiFunction::EXECUTE_GEMV_LIST);
+  // The list is given by the channel dimension of the operands, i.e., channel
+  // c of 'output' is the GEMV of channel c of 'vector' and 'matrix', which is
+  // the layout ExecuteGemv already handles. The rows of all list entries are
+  // split across the threads together, so entries run concurrently and the
+  // threads get equal shares of the total work. Unlike on PIM hardware, the
+  // weights do not need to be preprocessed, but may be converted with
+  // PimConvertGemvWeight for faster execution.
+  if (!output || !vector || !matrix) {
+    return OPERATION_ERROR;
+  }
+  return ExecuteGemv(call, output, vector, matrix, nullptr, false, stream,
+                     block);
+}
+
+namespace {
+
+// Normalizes 'pim_data' into 'output' on the thread pool, see PimExecuteBN.
+void RunBatchNorm(const PimBo *output, const PimBo *pim_data,
+                  const PimBo *beta, const PimBo *gamma, const PimBo *mean,
+                  const PimBo *variance, double epsilon) {
+  auto dataShape = pim_data->bshape;
+  auto *inPtr = static_cast<half_t *>(pim_data->data);
+  auto *outPtr = static_cast<half_t *>(output->data);
+  // Split the (n, c) planes into ranges of elements, so that the work is also
+  // distributed if there are only few, large planes. The planes are processed
+  // including the padding of their rows.
+  size_t numElements = NumElements(pim_data);
+  size_t planeSize =
+      numElements / std::max<size_t>(size_t{dataShape.n} * dataShape.c, 1);
+  auto batchNorm = kernels::GetKernels().batchNorm;
+  auto normalize = [&](size_t begin, size_t end) {
+    for (size_t planeBegin = begin; planeBegin < end;) {
+      size_t plane = planeBegin / planeSize;
+      size_t planeEnd = std::min((plane + 1) * planeSize, end);
+      size_t c = plane % dataShape.c;
+      // Assuming that n, h and w are all '1' for these buffers.
+      auto sBeta = static_cast<half_t *>(beta->data)[c];
+      auto sGamma = static_cast<half_t *>(gamma->data)[c];
+      auto sMean = static_cast<half_t *>(mean->data)[c];
+      auto sDivisor = sqrt(static_cast<half_t *>(variance->data)[c] +
+                           static_cast<half_t>(epsilon));
+      batchNorm(outPtr + planeBegin, inPtr + planeBegin, sMean, sDivisor,
+                sGamma, sBeta, planeEnd - planeBegin);
+      planeBegin = planeEnd;
+    }
+  };
+  ParallelFor(numElements, ELT_GRAIN, ELT_ALIGN, normalize);
+}
 
+} // anonymous namespace
+
+int PimExecuteBN(PimBo *output, PimBo *pim_data, PimBo *beta, PimBo *gamma,
+                 PimBo *mean, PimBo *variance, double epsilon, void *stream,
+                 bool block) {
+  ApiCall call(ApiFunction::EXECUTE_BN);
+  call.SetBuffer(output);
   // The PIM SDK uses the following layout for the operands and result of BN,
   // each given as (w, h, c, n):
   // output:    (W, H, C, N)
@@ -462,41 +1327,163 @@ int PimExecuteBN(PimBo *output, PimBo *pim_data, PimBo *beta, PimBo *gamma,
   // epsilon:   single scalar
 
   size_t numChannels = pim_data->bshape.c;
-  if (output->size != pim_data->size || beta->bshape.c != numChannels ||
+  if (!SameStorage(output, pim_data) || beta->bshape.c != numChannels ||
       gamma->bshape.c != numChannels || mean->bshape.c != numChannels ||
       variance->bshape.c != numChannels) {
     return OPERATION_ERROR;
   }
-
-  auto dataShape = pim_data->bshape;
-  auto *inPtr = static_cast<half_t *>(pim_data->data);
-  auto *outPtr = static_cast<half_t *>(output->data);
-  for (size_t n = 0; n < dataShape.n; ++n) {
-    for (size_t c = 0; c < dataShape.c; ++c) {
-      size_t dataOffset = n * dataShape.c * dataShape.h * dataShape.w +
-                          c * dataShape.h * dataShape.w;
-      // Assuming that n, h and w are all '1' for these buffers.
-      auto sBeta = static_cast<half_t *>(beta->data)[c];
-      auto sGamma = static_cast<half_t *>(gamma->data)[c];
-      auto sMean = static_cast<half_t *>(mean->data)[c];
-      auto sDivisor = sqrt(static_cast<half_t *>(variance->data)[c] +
-                           static_cast<half_t>(epsilon));
-      for (size_t i = 0; i < dataShape.h * dataShape.w; ++i) {
-        auto x = inPtr[dataOffset + i];
-        auto x_norm = (x - sMean) / sDivisor;
-        outPtr[dataOffset + i] = sGamma * x_norm + sBeta;
-      }
+  // Normalization needs fractional values, it is only supported for FP16.
+  for (PimBo *bo : {output, pim_data, beta, gamma, mean, variance}) {
+    if (bo->precision != PIM_FP16 || !IsRaw(bo)) {
+      return OPERATION_ERROR;
     }
   }
+  call.SetTraffic(pim_data->size + beta->size + gamma->size + mean->size +
+                      variance->size,
+                  output->size, NumElements(pim_data));
+  return Launch(stream, block,
+                {[=, out = *output, in = *pim_data, b = *beta, g = *gamma,
+                  m = *mean, v = *variance] {
+                  RunBatchNorm(&out, &in, &b, &g, &m, &v, epsilon);
+                }});
+}
+
+int PimSynchronize(void *stream) {
+  ApiCall call(ApiFunction::SYNCHRONIZE);
+  // The default stream waits for all streams of the current device, like the
+  // null stream of HIP.
+  if (!stream) {
+    CurrentDevice().SynchronizeStreams();
+  } else {
+    CurrentDevice().GetStream(stream)->Synchronize();
+  }
+  return SUCCESS;
+}
+
+// An event marks the point of its stream at which it was recorded, i.e., the
+// number of operations submitted to the stream before. It completes when the
+// completion counter of the stream reaches that number, so querying it does
+// not lock. Events which were never recorded are complete.
+struct __PimEvent {
+  std::shared_ptr<Stream> stream;
+  uint64_t target = 0;
+
+  bool Completed() const { return !stream || stream->Completed(target); }
+};
+
+void *PimCreateStream() { return CurrentDevice().CreateStream(); }
+
+int PimDestroyStream(void *stream) {
+  if (!stream || !CurrentDevice().DestroyStream(stream)) {
+    return OPERATION_ERROR;
+  }
+  return SUCCESS;
+}
+
+PimEvent *PimCreateEvent() { return new PimEvent; }
+
+int PimDestroyEvent(PimEvent *event) {
+  delete event;
   return SUCCESS;
 }
 
-int PimSynchronize(void *) {
-  // Currently nothing to do for synchronization.
+int PimRecordEvent(PimEvent *event, void *stream) {
+  // Graphs hold no events, see PimBeginCapture.
+  if (!event || IsCapturing(stream)) {
+    return OPERATION_ERROR;
+  }
+  event->stream = CurrentDevice().GetStream(stream);
+  event->target = event->stream->Record();
+  return SUCCESS;
+}
+
+int PimStreamWaitEvent(void *stream, PimEvent *event) {
+  if (!event) {
+    return OPERATION_ERROR;
+  }
+  std::shared_ptr<Stream> waiting = CurrentDevice().GetStream(stream);
+  if (waiting->Capturing()) {
+    return OPERATION_ERROR;
+  }
+  if (event->Completed() || event->stream == waiting) {
+    // Operations of the same stream already run in order.
+    return SUCCESS;
+  }
+  // The later operations of 'waiting' are held back by an operation waiting
+  // for the event, the host thread returns immediately.
+  waiting->Submit(
+      [source = event->stream, target = event->target] {
+        source->Wait(target);
+      },
+      false);
+  return SUCCESS;
+}
+
+int PimQueryEvent(PimEvent *event) {
+  if (!event) {
+    return OPERATION_ERROR;
+  }
+  return event->Completed() ? SUCCESS : EVENT_PENDING;
+}
+
+int PimSynchronizeEvent(PimEvent *event) {
+  if (!event) {
+    return OPERATION_ERROR;
+  }
+  if (!event->Completed()) {
+    event->stream->Wait(event->target);
+  }
+  return SUCCESS;
+}
+
+// A graph is allocated when the capture begins and filled by Launch.
+struct __PimGraph : Graph {};
+
+int PimBeginCapture(void *stream) {
+  std::shared_ptr<Stream> target = CurrentDevice().GetStream(stream);
+  if (target->Capturing()) {
+    return OPERATION_ERROR;
+  }
+  // Deferred operations were issued before the capture.
+  target->Flush();
+  target->SetCapture(new PimGraph);
+  return SUCCESS;
+}
+
+PimGraph *PimEndCapture(void *stream) {
+  std::shared_ptr<Stream> target = CurrentDevice().GetStream(stream);
+  auto *graph = static_cast<PimGraph *>(target->Capturing());
+  if (!graph) {
+    return nullptr;
+  }
+  target->SetCapture(nullptr);
+  // The operands were validated when the operations were captured, replays
+  // only run the fused nodes.
+  graph->Finalize();
+  return graph;
+}
+
+int PimLaunchGraph(PimGraph *graph, void *stream, bool block) {
+  if (!graph) {
+    return OPERATION_ERROR;
+  }
+  return Launch(stream, block, {[runner = graph->Runner()] {
+                  TraceScope span("PimLaunchGraph");
+                  runner();
+                }});
+}
+
+uint32_t PimGetGraphNumNodes(PimGraph *graph) {
+  return graph ? static_cast<uint32_t>(graph->NumNodes()) : 0u;
+}
+
+int PimDestroyGraph(PimGraph *graph) {
+  delete graph;
   return SUCCESS;
 }
 
 int PimExecuteDummy() {
+  ApiCall call(ApiFunction::EXECUTE_DUMMY);
   // Nothing to do here.
   return SUCCESS;
 }
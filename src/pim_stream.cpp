@@ -0,0 +1,132 @@
+/*
+ * Copyright (C) 2021 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system, or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#include "pim_stream.h"
+
+#include "pim_device.h"
+#include "pim_numa.h"
+#include "pim_trace.h"
+#include <utility>
+
+namespace pim {
+namespace mock {
+
+void Stream::Stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    FlushLocked();
+    stop = true;
+  }
+  changed.notify_all();
+  if (worker.joinable()) {
+    worker.join();
+  }
+}
+
+void Stream::Submit(std::function<void()> op, bool block) {
+  std::unique_lock<std::mutex> lock(mutex);
+  FlushLocked();
+  if (!block) {
+    Enqueue(std::move(op));
+    return;
+  }
+  ++submitted;
+  changed.wait(lock, [this] { return queue.empty() && !busy; });
+  busy = true;
+  lock.unlock();
+  op();
+  lock.lock();
+  busy = false;
+  completed.fetch_add(1, std::memory_order_release);
+  lock.unlock();
+  changed.notify_all();
+}
+
+void Stream::Defer(Operation op) {
+  std::lock_guard<std::mutex> lock(mutex);
+  if (!CanFuse(deferred, op)) {
+    FlushLocked();
+  }
+  deferred.push_back(std::move(op));
+}
+
+void Stream::Flush() {
+  std::lock_guard<std::mutex> lock(mutex);
+  FlushLocked();
+}
+
+void Stream::Enqueue(std::function<void()> op) {
+  ++submitted;
+  queue.push_back(std::move(op));
+  if (!worker.joinable()) {
+    worker = std::thread([this] { WorkerLoop(); });
+  }
+  changed.notify_all();
+}
+
+void Stream::FlushLocked() {
+  if (deferred.empty()) {
+    return;
+  }
+  Enqueue(FuseOperations(std::move(deferred)));
+  deferred.clear();
+}
+
+void Stream::Synchronize() {
+  std::unique_lock<std::mutex> lock(mutex);
+  FlushLocked();
+  changed.wait(lock, [this] { return queue.empty() && !busy; });
+}
+
+uint64_t Stream::Record() {
+  std::lock_guard<std::mutex> lock(mutex);
+  FlushLocked();
+  return submitted;
+}
+
+void Stream::Wait(uint64_t target) {
+  if (Completed(target)) {
+    return;
+  }
+  std::unique_lock<std::mutex> lock(mutex);
+  changed.wait(lock, [this, target] { return Completed(target); });
+}
+
+void Stream::WorkerLoop() {
+  SetCurrentDevice(deviceId);
+  BindThreadToNode(DeviceNumaNode(deviceId));
+  SetTraceLane("stream", static_cast<int>(deviceId));
+  std::unique_lock<std::mutex> lock(mutex);
+  for (;;) {
+    // Operations enqueued before the stream is destroyed still run.
+    changed.wait(lock, [this] { return stop || (!queue.empty() && !busy); });
+    if (queue.empty()) {
+      return;
+    }
+    if (busy) {
+      // Stopping while a blocking operation is executing.
+      changed.wait(lock, [this] { return !busy; });
+      continue;
+    }
+    std::function<void()> op = std::move(queue.front());
+    queue.pop_front();
+    busy = true;
+    lock.unlock();
+    op();
+    lock.lock();
+    busy = false;
+    completed.fetch_add(1, std::memory_order_release);
+    changed.notify_all();
+  }
+}
+
+} // namespace mock
+} // namespace pim
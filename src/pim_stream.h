@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2021 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system, or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#ifndef _PIM_STREAM_H_
+#define _PIM_STREAM_H_
+
+#include "pim_graph.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace pim {
+namespace mock {
+
+// In-order queue of the operations of a stream of an emulated device. Non-
+// blocking operations are executed by a host thread of the stream, which is
+// started on the first of them and runs with the device selected, so that
+// the operations use the thread pool of the device. Blocking operations are
+// executed by the calling thread, after all operations enqueued before them.
+// The operations are numbered in submission order and complete in order, so
+// the progress of the stream is a single counter, which events compare with
+// the number of operations submitted before them. Element-wise operations
+// may also be deferred, adjacent ones are then submitted as one fused
+// operation before anything depending on them, i.e., before the next
+// submitted operation, event or synchronization.
+class Stream {
+public:
+  explicit Stream(uint32_t deviceId) : deviceId(deviceId) {}
+
+  ~Stream() { Stop(); }
+
+  Stream(const Stream &) = delete;
+  Stream &operator=(const Stream &) = delete;
+
+  // Runs 'op' after all operations submitted before. If 'block' is set, runs
+  // 'op' on the calling thread and returns when it completed, otherwise
+  // enqueues 'op' and returns immediately.
+  void Submit(std::function<void()> op, bool block);
+
+  // Defers the element-wise operation 'op', see Operation. The deferred
+  // operations are submitted first if 'op' cannot be fused with them.
+  void Defer(Operation op);
+
+  // Submits the deferred operations.
+  void Flush();
+
+  // Waits until all operations submitted before completed.
+  void Synchronize();
+
+  // Returns the number of operations submitted so far, the target of an
+  // event recorded now.
+  uint64_t Record();
+
+  // Whether the first 'target' operations completed. Does not lock.
+  bool Completed(uint64_t target) const {
+    return completed.load(std::memory_order_acquire) >= target;
+  }
+
+  // Waits until the first 'target' operations completed.
+  void Wait(uint64_t target);
+
+  // Waits for all enqueued operations and stops the thread of the stream.
+  void Stop();
+
+  // The graph capturing the operations issued to the stream instead of
+  // executing them, nullptr if the stream is not capturing.
+  Graph *Capturing() const { return capture.load(std::memory_order_acquire); }
+
+  void SetCapture(Graph *graph) {
+    capture.store(graph, std::memory_order_release);
+  }
+
+private:
+  void WorkerLoop();
+
+  // Both are called with the mutex held.
+  void Enqueue(std::function<void()> op);
+  void FlushLocked();
+
+  uint32_t deviceId;
+  std::thread worker;
+
+  std::mutex mutex;
+  // Signaled when an operation is enqueued or completed.
+  std::condition_variable changed;
+  std::deque<std::function<void()>> queue;
+  // Whether an operation is executing, either on the worker or inline.
+  bool busy = false;
+  bool stop = false;
+  uint64_t submitted = 0;
+  // Written under the mutex, read without it by Completed.
+  std::atomic<uint64_t> completed{0};
+  std::atomic<Graph *> capture{nullptr};
+  std::vector<Operation> deferred;
+};
+
+} // namespace mock
+} // namespace pim
+
+#endif /* _PIM_STREAM_H_ */
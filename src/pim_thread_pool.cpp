@@ -0,0 +1,145 @@
+/*
+ * Copyright (C) 2021 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system, or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#include "pim_thread_pool.h"
+
+#include "pim_numa.h"
+#include "pim_trace.h"
+#include <algorithm>
+#include <cstdlib>
+#include <memory>
+
+namespace pim {
+namespace mock {
+
+namespace {
+// Set on the worker threads of all pools.
+thread_local bool isWorker = false;
+} // anonymous namespace
+
+ThreadPool::ThreadPool(size_t numThreads, int node, int device)
+    : node(node), device(device) {
+  numThreads = std::max<size_t>(numThreads, 1);
+  workers.reserve(numThreads - 1);
+  for (size_t i = 1; i < numThreads; ++i) {
+    workers.emplace_back([this] { WorkerLoop(); });
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stop = true;
+  }
+  wakeCondition.notify_all();
+  for (auto &worker : workers) {
+    worker.join();
+  }
+}
+
+void ThreadPool::ParallelFor(size_t count, size_t grain, size_t align,
+                             RangeFn fn, void *context) {
+  if (!count) {
+    return;
+  }
+  // Only one job can be in flight at a time. Nested calls from the workers or
+  // concurrent calls from other host threads process their range inline.
+  // Workers never dispatch, so that the pools of different devices do not
+  // wait for each other.
+  std::unique_lock<std::mutex> dispatch(dispatchMutex, std::defer_lock);
+  if (!isWorker) {
+    dispatch.try_lock();
+  }
+  grain = std::max<size_t>(grain, 1);
+  size_t numChunks = std::min((count + grain - 1) / grain, NumThreads());
+  if (!dispatch.owns_lock() || numChunks <= 1) {
+    fn(context, 0, count);
+    return;
+  }
+  align = std::max<size_t>(align, 1);
+  size_t chunkSize = (count + numChunks - 1) / numChunks;
+  chunkSize = (chunkSize + align - 1) / align * align;
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    jobFn = fn;
+    jobContext = context;
+    jobCount = count;
+    jobChunkSize = chunkSize;
+    jobNumChunks = (count + chunkSize - 1) / chunkSize;
+    nextChunk.store(0, std::memory_order_relaxed);
+    activeWorkers = workers.size();
+    ++generation;
+  }
+  wakeCondition.notify_all();
+
+  RunChunks();
+
+  std::unique_lock<std::mutex> lock(mutex);
+  doneCondition.wait(lock, [this] { return activeWorkers == 0; });
+}
+
+void ThreadPool::RunChunks() {
+  for (;;) {
+    size_t chunk = nextChunk.fetch_add(1, std::memory_order_relaxed);
+    if (chunk >= jobNumChunks) {
+      return;
+    }
+    size_t begin = chunk * jobChunkSize;
+    size_t end = std::min(begin + jobChunkSize, jobCount);
+    jobFn(jobContext, begin, end);
+  }
+}
+
+void ThreadPool::WorkerLoop() {
+  isWorker = true;
+  BindThreadToNode(node);
+  SetTraceLane("worker", device);
+  uint64_t seenGeneration = 0;
+  for (;;) {
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      wakeCondition.wait(
+          lock, [&] { return stop || generation != seenGeneration; });
+      if (stop) {
+        return;
+      }
+      seenGeneration = generation;
+    }
+    {
+      TraceScope span("ParallelFor");
+      RunChunks();
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (--activeWorkers == 0) {
+        doneCondition.notify_one();
+      }
+    }
+  }
+}
+
+size_t DefaultNumThreads(int node) {
+  if (const char *env = std::getenv("PIMMOCK_NUM_THREADS")) {
+    char *end = nullptr;
+    unsigned long value = std::strtoul(env, &end, 10);
+    if (end != env && *end == '\0' && value > 0) {
+      return value;
+    }
+  }
+  if (size_t nodeCpus = NumNodeCpus(node)) {
+    return nodeCpus;
+  }
+  return std::max(std::thread::hardware_concurrency(), 1u);
+}
+
+} // namespace mock
+} // namespace pim
@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2021 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system, or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#ifndef _PIM_THREAD_POOL_H_
+#define _PIM_THREAD_POOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace pim {
+namespace mock {
+
+// Simple fork-join thread pool. The thread calling ParallelFor participates in
+// the work, so a pool with N threads starts N - 1 worker threads. The workers
+// run on the CPUs of the NUMA node 'node', unless it is -1, and are traced as
+// threads of the device 'device', see SetTraceLane.
+class ThreadPool {
+public:
+  using RangeFn = void (*)(void *context, size_t begin, size_t end);
+
+  explicit ThreadPool(size_t numThreads, int node = -1, int device = -1);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  size_t NumThreads() const { return workers.size() + 1; }
+
+  int Node() const { return node; }
+
+  // Splits [0, count) into chunks of at least 'grain' elements, with all chunk
+  // boundaries being multiples of 'align', and calls 'fn' for each chunk.
+  // Each element is processed by exactly one call. If the pool is already busy
+  // with another ParallelFor (e.g., calls from another host thread), or the
+  // caller is a worker of any pool, the range is processed on the calling
+  // thread.
+  void ParallelFor(size_t count, size_t grain, size_t align, RangeFn fn,
+                   void *context);
+
+private:
+  void WorkerLoop();
+  void RunChunks();
+
+  int node;
+  int device;
+  std::vector<std::thread> workers;
+  std::mutex dispatchMutex;
+
+  std::mutex mutex;
+  std::condition_variable wakeCondition;
+  std::condition_variable doneCondition;
+  uint64_t generation = 0;
+  size_t activeWorkers = 0;
+  bool stop = false;
+
+  // Description of the current job.
+  RangeFn jobFn = nullptr;
+  void *jobContext = nullptr;
+  size_t jobCount = 0;
+  size_t jobChunkSize = 0;
+  size_t jobNumChunks = 0;
+  std::atomic<size_t> nextChunk{0};
+};
+
+// The thread pool of the device selected by the calling thread, nullptr if no
+// pool is running, see pim_device.h.
+std::shared_ptr<ThreadPool> CurrentThreadPool();
+
+// Thread count used for 'numThreads == 0': the value of the environment
+// variable PIMMOCK_NUM_THREADS if set, the number of CPUs of the NUMA node
+// 'node' if it is not -1, the number of hardware threads otherwise.
+size_t DefaultNumThreads(int node = -1);
+
+// Runs 'fn(begin, end)' for chunks of [0, count) on the thread pool of the
+// current device, see ThreadPool::ParallelFor.
+template <typename Fn>
+void ParallelFor(size_t count, size_t grain, size_t align, const Fn &fn) {
+  std::shared_ptr<ThreadPool> pool = CurrentThreadPool();
+  if (!pool || count <= grain) {
+    if (count) {
+      fn(size_t{0}, count);
+    }
+    return;
+  }
+  pool->ParallelFor(
+      count, grain, align,
+      [](void *context, size_t begin, size_t end) {
+        (*static_cast<const Fn *>(context))(begin, end);
+      },
+      const_cast<void *>(static_cast<const void *>(&fn)));
+}
+
+template <typename Fn>
+void ParallelFor(size_t count, size_t grain, const Fn &fn) {
+  ParallelFor(count, grain, 1, fn);
+}
+
+} // namespace mock
+} // namespace pim
+
+#endif /* _PIM_THREAD_POOL_H_ */
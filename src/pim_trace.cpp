@@ -0,0 +1,361 @@
+/*
+ * Copyright (C) 2021 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system, or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#include "pim_trace.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace pim {
+namespace mock {
+
+namespace {
+
+struct TraceEvent {
+  const char *name;
+  // Nanoseconds since the start of the trace.
+  uint64_t begin;
+  uint64_t duration;
+  TraceArgs args;
+};
+
+// The spans of a thread during one trace. The thread writes the ring at
+// 'head', FlushTrace drains it from 'tail' while holding the mutex of the
+// tracer.
+struct TraceBuffer {
+  TraceBuffer(uint64_t trace, const char *kind, int device, uint32_t ordinal,
+              uint32_t lane, size_t capacity)
+      : trace(trace), kind(kind), device(device), ordinal(ordinal),
+        lane(lane), ring(capacity) {}
+
+  uint64_t trace;
+  const char *kind;
+  int device;
+  uint32_t ordinal;
+  uint32_t lane;
+  std::vector<TraceEvent> ring;
+  std::atomic<uint64_t> head{0};
+  std::atomic<uint64_t> tail{0};
+  std::atomic<uint64_t> dropped{0};
+  std::atomic<bool> exited{false};
+  // Only accessed while holding the mutex of the tracer.
+  bool described = false;
+  uint64_t reportedDropped = 0;
+};
+
+// The trace file and the buffers of all threads for the current trace.
+// Buffers of threads which exited are kept until they are drained. Every
+// trace starts with new buffers, which the threads allocate on their first
+// span. Leaked, so that threads may exit after static destruction.
+struct Tracer {
+  std::mutex mutex;
+  std::FILE *file = nullptr;
+  bool firstEvent = true;
+  std::vector<std::shared_ptr<TraceBuffer>> buffers;
+  std::map<std::pair<int, std::string>, uint32_t> numLanes;
+  std::set<int> describedDevices;
+  uint32_t nextLane = 0;
+  size_t capacity = 0;
+  std::atomic<bool> enabled{false};
+  std::atomic<TraceClock::rep> start{0};
+  // Number of traces started.
+  std::atomic<uint64_t> trace{0};
+};
+
+Tracer &GetTracer() {
+  static Tracer *tracer = new Tracer;
+  return *tracer;
+}
+
+// The lane of the calling thread, see SetTraceLane.
+struct LocalLane {
+  const char *kind = "host thread";
+  int device = -1;
+  std::shared_ptr<TraceBuffer> buffer;
+
+  ~LocalLane() {
+    if (buffer) {
+      buffer->exited.store(true, std::memory_order_release);
+    }
+  }
+};
+
+thread_local LocalLane localLane;
+
+// Spans buffered per thread: the value of the environment variable
+// PIMMOCK_TRACE_EVENTS if set, 16Ki otherwise.
+size_t DefaultTraceEvents() {
+  if (const char *env = std::getenv("PIMMOCK_TRACE_EVENTS")) {
+    char *end = nullptr;
+    unsigned long long value = std::strtoull(env, &end, 10);
+    if (end != env && *end == '\0' && value > 0) {
+      return value;
+    }
+  }
+  return 16 * 1024;
+}
+
+TraceBuffer &LocalBuffer(Tracer &tracer) {
+  uint64_t trace = tracer.trace.load(std::memory_order_acquire);
+  if (!localLane.buffer || localLane.buffer->trace != trace) {
+    std::lock_guard<std::mutex> lock(tracer.mutex);
+    uint32_t &ordinal =
+        tracer.numLanes[{localLane.device, std::string(localLane.kind)}];
+    localLane.buffer = std::make_shared<TraceBuffer>(
+        tracer.trace.load(std::memory_order_relaxed), localLane.kind,
+        localLane.device, ordinal++, tracer.nextLane++,
+        std::max<size_t>(tracer.capacity, 1));
+    tracer.buffers.push_back(localLane.buffer);
+  }
+  return *localLane.buffer;
+}
+
+// The host has process id 0 in the trace, device d has d + 1.
+int ProcessId(int device) { return device + 1; }
+
+const char *PrecisionName(PimPrecision precision) {
+  switch (precision) {
+  case PIM_FP16:
+    return "PIM_FP16";
+  case PIM_INT8:
+    return "PIM_INT8";
+  default:
+    return "unknown";
+  }
+}
+
+const char *MemTypeName(PimMemType memType) {
+  switch (memType) {
+  case MEM_TYPE_HOST:
+    return "MEM_TYPE_HOST";
+  case MEM_TYPE_DEVICE:
+    return "MEM_TYPE_DEVICE";
+  case MEM_TYPE_PIM:
+    return "MEM_TYPE_PIM";
+  default:
+    return "unknown";
+  }
+}
+
+void BeginEvent(Tracer &tracer) {
+  std::fputs(tracer.firstEvent ? "" : ",\n", tracer.file);
+  tracer.firstEvent = false;
+}
+
+void WriteMetadata(Tracer &tracer, const char *what, int pid, uint32_t tid,
+                   const std::string &name) {
+  BeginEvent(tracer);
+  std::fprintf(tracer.file,
+               "{\"name\":\"%s\",\"ph\":\"M\",\"pid\":%d,\"tid\":%u,"
+               "\"args\":{\"name\":\"%s\"}}",
+               what, pid, tid, name.c_str());
+}
+
+void DescribeLane(Tracer &tracer, const TraceBuffer &buffer) {
+  int pid = ProcessId(buffer.device);
+  if (tracer.describedDevices.insert(buffer.device).second) {
+    WriteMetadata(tracer, "process_name", pid, 0,
+                  buffer.device < 0
+                      ? std::string("host")
+                      : "device " + std::to_string(buffer.device));
+  }
+  WriteMetadata(tracer, "thread_name", pid, buffer.lane,
+                std::string(buffer.kind) + " " +
+                    std::to_string(buffer.ordinal));
+}
+
+void WriteEvent(Tracer &tracer, const TraceBuffer &buffer,
+                const TraceEvent &event) {
+  BeginEvent(tracer);
+  std::fprintf(tracer.file,
+               "{\"name\":\"%s\",\"ph\":\"X\",\"pid\":%d,\"tid\":%u,"
+               "\"ts\":%.3f,\"dur\":%.3f,\"args\":{",
+               event.name, ProcessId(buffer.device), buffer.lane,
+               event.begin * 1e-3, event.duration * 1e-3);
+  const TraceArgs &args = event.args;
+  const char *separator = "";
+  if (args.hasBuffer) {
+    std::fprintf(tracer.file,
+                 "\"shape\":\"(w=%u, h=%u, c=%u, n=%u)\","
+                 "\"precision\":\"%s\",\"mem_type\":\"%s\"",
+                 args.shape.w, args.shape.h, args.shape.c, args.shape.n,
+                 PrecisionName(args.precision), MemTypeName(args.memType));
+    separator = ",";
+  }
+  for (auto value : {std::make_pair("bytes_read", args.bytesRead),
+                     std::make_pair("bytes_written", args.bytesWritten),
+                     std::make_pair("elements", args.elements)}) {
+    if (value.second) {
+      std::fprintf(tracer.file, "%s\"%s\":%llu", separator, value.first,
+                   static_cast<unsigned long long>(value.second));
+      separator = ",";
+    }
+  }
+  std::fputs("}}", tracer.file);
+}
+
+void FlushLocked(Tracer &tracer) {
+  if (!tracer.file) {
+    return;
+  }
+  double now = static_cast<double>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          TraceClock::now().time_since_epoch() -
+          TraceClock::duration(tracer.start.load(std::memory_order_relaxed)))
+          .count());
+  for (auto it = tracer.buffers.begin(); it != tracer.buffers.end();) {
+    TraceBuffer &buffer = **it;
+    // The spans of a thread which exited are all visible once 'exited' is.
+    bool exited = buffer.exited.load(std::memory_order_acquire);
+    uint64_t tail = buffer.tail.load(std::memory_order_relaxed);
+    uint64_t head = buffer.head.load(std::memory_order_acquire);
+    if (!buffer.described && tail != head) {
+      DescribeLane(tracer, buffer);
+      buffer.described = true;
+    }
+    for (; tail != head; ++tail) {
+      WriteEvent(tracer, buffer, buffer.ring[tail % buffer.ring.size()]);
+    }
+    buffer.tail.store(tail, std::memory_order_release);
+    uint64_t dropped = buffer.dropped.load(std::memory_order_relaxed);
+    if (dropped != buffer.reportedDropped) {
+      // Marks the flush at which the spans were found to be dropped.
+      BeginEvent(tracer);
+      std::fprintf(tracer.file,
+                   "{\"name\":\"%llu spans dropped\",\"ph\":\"i\","
+                   "\"s\":\"t\",\"pid\":%d,\"tid\":%u,\"ts\":%.3f}",
+                   static_cast<unsigned long long>(dropped -
+                                                   buffer.reportedDropped),
+                   ProcessId(buffer.device), buffer.lane, now * 1e-3);
+      buffer.reportedDropped = dropped;
+    }
+    it = exited ? tracer.buffers.erase(it) : it + 1;
+  }
+  std::fflush(tracer.file);
+}
+
+void StopLocked(Tracer &tracer) {
+  if (!tracer.file) {
+    return;
+  }
+  tracer.enabled.store(false, std::memory_order_relaxed);
+  FlushLocked(tracer);
+  std::fputs("\n]\n", tracer.file);
+  std::fclose(tracer.file);
+  tracer.file = nullptr;
+}
+
+} // anonymous namespace
+
+void TraceArgs::SetBuffer(const PimBo *bo) {
+  if (!bo) {
+    return;
+  }
+  hasBuffer = true;
+  shape = bo->bshape;
+  precision = bo->precision;
+  memType = bo->mem_type;
+}
+
+bool TracingEnabled() {
+  return GetTracer().enabled.load(std::memory_order_relaxed);
+}
+
+void TraceSpan(const char *name, TraceClock::time_point begin,
+               TraceClock::time_point end, const TraceArgs &args) {
+  Tracer &tracer = GetTracer();
+  if (!tracer.enabled.load(std::memory_order_relaxed)) {
+    return;
+  }
+  TraceBuffer &buffer = LocalBuffer(tracer);
+  uint64_t head = buffer.head.load(std::memory_order_relaxed);
+  if (head - buffer.tail.load(std::memory_order_acquire) ==
+      buffer.ring.size()) {
+    buffer.dropped.store(buffer.dropped.load(std::memory_order_relaxed) + 1,
+                         std::memory_order_relaxed);
+    return;
+  }
+  // Spans which began before the trace are clipped to its start.
+  TraceClock::rep start = tracer.start.load(std::memory_order_relaxed);
+  TraceClock::rep first = std::max(begin.time_since_epoch().count(), start);
+  TraceClock::rep last = std::max(end.time_since_epoch().count(), first);
+  TraceEvent &event = buffer.ring[head % buffer.ring.size()];
+  event.name = name;
+  event.begin = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    TraceClock::duration(first - start))
+                    .count();
+  event.duration = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       TraceClock::duration(last - first))
+                       .count();
+  event.args = args;
+  buffer.head.store(head + 1, std::memory_order_release);
+}
+
+void SetTraceLane(const char *kind, int device) {
+  localLane.kind = kind;
+  localLane.device = device;
+}
+
+bool StartTrace(const char *path) {
+  Tracer &tracer = GetTracer();
+  std::lock_guard<std::mutex> lock(tracer.mutex);
+  StopLocked(tracer);
+  tracer.file = std::fopen(path, "w");
+  if (!tracer.file) {
+    return false;
+  }
+  std::fputs("[\n", tracer.file);
+  tracer.firstEvent = true;
+  tracer.describedDevices.clear();
+  // Spans recorded after the previous trace was stopped are discarded with
+  // the buffers.
+  tracer.buffers.clear();
+  tracer.numLanes.clear();
+  tracer.nextLane = 0;
+  tracer.trace.fetch_add(1, std::memory_order_release);
+  tracer.capacity = DefaultTraceEvents();
+  tracer.start.store(TraceClock::now().time_since_epoch().count(),
+                     std::memory_order_relaxed);
+  tracer.enabled.store(true, std::memory_order_release);
+  return true;
+}
+
+void FlushTrace() {
+  Tracer &tracer = GetTracer();
+  std::lock_guard<std::mutex> lock(tracer.mutex);
+  FlushLocked(tracer);
+}
+
+void StopTrace() {
+  Tracer &tracer = GetTracer();
+  std::lock_guard<std::mutex> lock(tracer.mutex);
+  StopLocked(tracer);
+}
+
+void StartTraceIfRequested() {
+  const char *env = std::getenv("PIMMOCK_TRACE");
+  if (!env || !*env || TracingEnabled()) {
+    return;
+  }
+  StartTrace(env);
+}
+
+} // namespace mock
+} // namespace pim
@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2021 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system, or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#ifndef _PIM_TRACE_H_
+#define _PIM_TRACE_H_
+
+#include "pim_data_types.h"
+#include <chrono>
+#include <cstdint>
+
+namespace pim {
+namespace mock {
+
+// Tracing records spans of the calls of the API and of the work of the
+// threads of the devices, and writes them as Chrome trace events, which
+// chrome://tracing and Perfetto display as timelines. Every thread has its
+// own lane and buffers its spans in a ring which only it writes, so recording
+// takes no locks. The rings are drained into the trace file by FlushTrace.
+// Spans recorded while a ring is full are dropped.
+
+using TraceClock = std::chrono::steady_clock;
+
+// Arguments of a span, shown by the trace viewers.
+struct TraceArgs {
+  // The shape, precision and memory type of the buffer of the span, if set.
+  bool hasBuffer = false;
+  PimBShape shape{};
+  PimPrecision precision = PIM_FP16;
+  PimMemType memType = MEM_TYPE_HOST;
+  uint64_t bytesRead = 0;
+  uint64_t bytesWritten = 0;
+  uint64_t elements = 0;
+
+  // Sets the buffer of the span to 'bo', unless it is nullptr.
+  void SetBuffer(const PimBo *bo);
+};
+
+// Whether spans are recorded, i.e., StartTrace was called and StopTrace was
+// not.
+bool TracingEnabled();
+
+// Records the span 'name' from 'begin' to 'end' on the lane of the calling
+// thread, if tracing is enabled. 'name' must be a string literal.
+void TraceSpan(const char *name, TraceClock::time_point begin,
+               TraceClock::time_point end, const TraceArgs &args = {});
+
+// Records the span 'name' from construction to destruction, if tracing is
+// enabled at construction.
+class TraceScope {
+public:
+  explicit TraceScope(const char *name, const TraceArgs &args = {})
+      : name(TracingEnabled() ? name : nullptr), args(args) {
+    if (this->name) {
+      begin = TraceClock::now();
+    }
+  }
+  ~TraceScope() {
+    if (name) {
+      TraceSpan(name, begin, TraceClock::now(), args);
+    }
+  }
+
+  TraceScope(const TraceScope &) = delete;
+  TraceScope &operator=(const TraceScope &) = delete;
+
+private:
+  const char *name;
+  TraceArgs args;
+  TraceClock::time_point begin;
+};
+
+// Names the lane of the calling thread, e.g., "stream", numbered among the
+// lanes of the same kind of the device 'device', or of the host if 'device'
+// is -1. 'kind' must be a string literal. Lanes of threads which were not
+// named are host threads.
+void SetTraceLane(const char *kind, int device);
+
+// Starts recording spans, to be written to the file 'path', replacing it.
+// Returns false if the file cannot be created.
+bool StartTrace(const char *path);
+
+// Writes the spans recorded so far to the trace file.
+void FlushTrace();
+
+// Writes the remaining spans, completes the trace file and stops recording.
+void StopTrace();
+
+// Starts recording spans to the file given by the environment variable
+// PIMMOCK_TRACE, if set and not already recording. Called by PimInitialize.
+void StartTraceIfRequested();
+
+} // namespace mock
+} // namespace pim
+
+#endif /* _PIM_TRACE_H_ */
@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2021 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system, or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#include "pim_mock_api.h"
+#include "pim_runtime_api.h"
+#include <gtest/gtest.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define LENGTH (64 * 1024)
+
+using namespace pim::mock;
+
+static PimApiStats get_stats(const char *name) {
+  uint32_t num_stats = 0;
+  PimGetApiStats(nullptr, &num_stats);
+  std::vector<PimApiStats> stats(num_stats);
+  EXPECT_EQ(PimGetApiStats(stats.data(), &num_stats), 0);
+  for (const PimApiStats &function : stats)
+    if (strcmp(function.name, name) == 0)
+      return function;
+  ADD_FAILURE() << "No statistics of " << name;
+  return PimApiStats{};
+}
+
+// The calls of all threads are counted, including threads which exited, and
+// the traffic of the calls with valid operands.
+TEST(UnitTest, PimApiStatsCounts) {
+  PimInitialize(RT_TYPE_HIP, PIM_FP16);
+  PimBo *input = PimCreateBo(LENGTH, 1, 1, 1, PIM_FP16, MEM_TYPE_PIM);
+  PimBo *output = PimCreateBo(LENGTH, 1, 1, 1, PIM_FP16, MEM_TYPE_PIM);
+  PimBo *other = PimCreateBo(LENGTH / 2, 1, 1, 1, PIM_FP16, MEM_TYPE_PIM);
+  EXPECT_EQ(PimResetApiStats(), 0);
+
+  const int num_calls = 3;
+  for (int i = 0; i < num_calls; i++)
+    PimExecuteAdd(output, input, input, nullptr, true);
+  EXPECT_NE(PimExecuteAdd(output, other, input, nullptr, true), 0);
+  std::thread worker([&] {
+    PimExecuteRelu(output, input, nullptr, true);
+    PimCopyMemory(output, input, DEVICE_TO_DEVICE);
+  });
+  worker.join();
+
+  PimApiStats add = get_stats("PimExecuteAdd");
+  EXPECT_EQ(add.num_calls, num_calls + 1u);
+  EXPECT_EQ(add.bytes_read, num_calls * 2u * input->size);
+  EXPECT_EQ(add.bytes_written, num_calls * output->size);
+  EXPECT_EQ(add.num_elements, num_calls * uint64_t{LENGTH});
+  EXPECT_LE(add.p50_ns, add.p90_ns);
+  EXPECT_LE(add.p90_ns, add.p99_ns);
+  EXPECT_LE(add.p99_ns, add.max_ns);
+  EXPECT_LE(add.max_ns, add.total_ns);
+  EXPECT_GT(add.max_ns, 0u);
+
+  PimApiStats relu = get_stats("PimExecuteRelu");
+  EXPECT_EQ(relu.num_calls, 1u);
+  EXPECT_EQ(relu.num_elements, uint64_t{LENGTH});
+  PimApiStats copy = get_stats("PimCopyMemory");
+  EXPECT_EQ(copy.num_calls, 1u);
+  EXPECT_EQ(copy.bytes_read, input->size);
+  EXPECT_EQ(copy.bytes_written, output->size);
+  EXPECT_EQ(get_stats("PimExecuteMul").num_calls, 0u);
+
+  // Statistics are reset for all threads.
+  EXPECT_EQ(PimResetApiStats(), 0);
+  EXPECT_EQ(get_stats("PimExecuteAdd").num_calls, 0u);
+  EXPECT_EQ(get_stats("PimExecuteRelu").num_calls, 0u);
+  PimExecuteAdd(output, input, input, nullptr, true);
+  EXPECT_EQ(get_stats("PimExecuteAdd").num_calls, 1u);
+
+  for (PimBo *bo : {input, output, other})
+    PimDestroyBo(bo);
+  PimDeinitialize();
+}
+
+// PimDeinitialize writes the statistics to the file given by the environment
+// variable PIMMOCK_API_STATS.
+TEST(UnitTest, PimApiStatsDump) {
+  char path[] = "/tmp/pim_api_stats_XXXXXX";
+  int fd = mkstemp(path);
+  ASSERT_GE(fd, 0);
+  close(fd);
+  setenv("PIMMOCK_API_STATS", path, 1);
+  PimInitialize(RT_TYPE_HIP, PIM_FP16);
+  PimBo *bo = PimCreateBo(LENGTH, 1, 1, 1, PIM_FP16, MEM_TYPE_PIM);
+  PimExecuteRelu(bo, bo, nullptr, true);
+  PimDestroyBo(bo);
+  PimDeinitialize();
+  unsetenv("PIMMOCK_API_STATS");
+
+  std::string dump;
+  FILE *file = fopen(path, "r");
+  ASSERT_NE(file, nullptr);
+  char buffer[256];
+  while (fgets(buffer, sizeof(buffer), file))
+    dump += buffer;
+  fclose(file);
+  remove(path);
+  EXPECT_NE(dump.find("PimExecuteRelu"), std::string::npos);
+  EXPECT_NE(dump.find("PimCreateBo"), std::string::npos);
+}
@@ -0,0 +1,161 @@
+/*
+ * Copyright (C) 2021 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system, or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#include "half.hpp"
+#include "pim_mock_api.h"
+#include "pim_runtime_api.h"
+#include <gtest/gtest.h>
+#include <random>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+#define IN_LENGTH (1024)
+#define OUT_LENGTH (2048)
+#define BATCH_DIM (2)
+#define NUM_DEVICES (3)
+
+using half_float::half;
+
+using namespace pim::mock;
+
+static void fill_random(PimBo *bo, uint32_t seed) {
+  std::mt19937 mt(seed);
+  std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+  half *data = static_cast<half *>(bo->data);
+  for (size_t i = 0; i < bo->size / sizeof(half); i++)
+    data[i] = half(dist(mt));
+}
+
+// Runs a GEMV on the current device with the weights of the given shard and
+// returns the result.
+static std::vector<char> run_shard(uint32_t shard) {
+  PimBo *input =
+      PimCreateBo(IN_LENGTH, 1, 1, BATCH_DIM, PIM_FP16, MEM_TYPE_DEVICE);
+  PimBo *weight =
+      PimCreateBo(IN_LENGTH, OUT_LENGTH, 1, 1, PIM_FP16, MEM_TYPE_DEVICE);
+  PimBo *output =
+      PimCreateBo(OUT_LENGTH, 1, 1, BATCH_DIM, PIM_FP16, MEM_TYPE_DEVICE);
+  fill_random(input, 1);
+  fill_random(weight, 2 + shard);
+  PimExecuteGemv(output, input, weight, nullptr, true);
+  char *data = static_cast<char *>(output->data);
+  std::vector<char> result(data, data + output->size);
+  for (PimBo *bo : {input, weight, output})
+    PimDestroyBo(bo);
+  return result;
+}
+
+// Buffers belong to the device selected by the creating thread, and every
+// device accounts for its own memory.
+TEST(UnitTest, PimDeviceContexts) {
+  PimInitialize(RT_TYPE_HIP, PIM_FP16);
+
+  PimMemoryPoolStats before0, before1, after0, after1;
+  PimGetMemoryPoolStats(&before0);
+  PimSetDevice(1);
+  PimGetMemoryPoolStats(&before1);
+  PimBo *bo = PimCreateBo(IN_LENGTH, 1, 1, 1, PIM_FP16, MEM_TYPE_DEVICE);
+  ASSERT_NE(bo, nullptr);
+  EXPECT_EQ(bo->device_id, 1u);
+  PimGetMemoryPoolStats(&after1);
+  half user_data[IN_LENGTH];
+  PimBo *user_bo = PimCreateBo(IN_LENGTH, 1, 1, 1, PIM_FP16, MEM_TYPE_DEVICE,
+                               user_data);
+  ASSERT_NE(user_bo, nullptr);
+  EXPECT_EQ(user_bo->device_id, 1u);
+  PimDestroyBo(user_bo);
+  EXPECT_EQ(after1.num_allocations, before1.num_allocations + 1);
+  EXPECT_GT(after1.bytes_in_use, before1.bytes_in_use);
+
+  // Other host threads start on device 0.
+  uint32_t other_device = 0;
+  std::thread([&] {
+    PimBo *other = PimCreateBo(IN_LENGTH, 1, 1, 1, PIM_FP16, MEM_TYPE_DEVICE);
+    other_device = other->device_id;
+    PimDestroyBo(other);
+  }).join();
+  EXPECT_EQ(other_device, 0u);
+
+  // Buffers may be destroyed with any device selected.
+  PimSetDevice(0);
+  PimDestroyBo(bo);
+  PimGetMemoryPoolStats(&after0);
+  EXPECT_EQ(after0.num_allocations, before0.num_allocations + 1);
+  EXPECT_EQ(after0.bytes_in_use, before0.bytes_in_use);
+  PimSetDevice(1);
+  PimGetMemoryPoolStats(&after1);
+  EXPECT_EQ(after1.bytes_in_use, before1.bytes_in_use);
+  PimSetDevice(0);
+
+  EXPECT_NE(PimSetDevice(1000), 0);
+  PimDeinitialize();
+}
+
+TEST(UnitTest, PimDeviceMemoryBudget) {
+  const size_t mega = 1024 * 1024;
+  setenv("PIMMOCK_DEVICE_MEMORY", "3145728", 1);
+  PimInitialize(RT_TYPE_HIP, PIM_FP16);
+  unsetenv("PIMMOCK_DEVICE_MEMORY");
+
+  PimSetDevice(2);
+  PimMemoryPoolStats stats;
+  PimGetMemoryPoolStats(&stats);
+  EXPECT_EQ(stats.bytes_budget, 3 * mega);
+  // Buffers of 2 MiB each, only one fits into the budget.
+  PimBo *first = PimCreateBo(mega, 1, 1, 1, PIM_FP16, MEM_TYPE_DEVICE);
+  PimBo *second = PimCreateBo(mega, 1, 1, 1, PIM_FP16, MEM_TYPE_DEVICE);
+  EXPECT_NE(first, nullptr);
+  EXPECT_EQ(second, nullptr);
+  // The budget is per device.
+  PimSetDevice(0);
+  PimBo *third = PimCreateBo(mega, 1, 1, 1, PIM_FP16, MEM_TYPE_DEVICE);
+  EXPECT_NE(third, nullptr);
+  // Freed memory is available again.
+  PimSetDevice(2);
+  PimDestroyBo(first);
+  second = PimCreateBo(mega, 1, 1, 1, PIM_FP16, MEM_TYPE_DEVICE);
+  EXPECT_NE(second, nullptr);
+
+  PimDestroyBo(second);
+  PimDestroyBo(third);
+  PimSetDevice(0);
+  PimDeinitialize();
+}
+
+// Host threads driving different devices run concurrently, with the same
+// results as one thread running all shards.
+TEST(UnitTest, PimDeviceConcurrentShards) {
+  PimSetNumThreads(2);
+  PimInitialize(RT_TYPE_HIP, PIM_FP16);
+
+  std::vector<std::vector<char>> golden;
+  for (uint32_t shard = 0; shard < NUM_DEVICES; shard++)
+    golden.push_back(run_shard(shard));
+
+  std::vector<std::vector<char>> results(NUM_DEVICES);
+  std::vector<std::thread> threads;
+  for (uint32_t shard = 0; shard < NUM_DEVICES; shard++) {
+    threads.emplace_back([&results, shard] {
+      PimSetDevice(shard);
+      EXPECT_EQ(PimGetNumThreads(), 2u);
+      results[shard] = run_shard(shard);
+    });
+  }
+  for (std::thread &thread : threads)
+    thread.join();
+  for (uint32_t shard = 0; shard < NUM_DEVICES; shard++)
+    EXPECT_TRUE(results[shard] == golden[shard]) << "shard " << shard;
+
+  PimDeinitialize();
+  PimSetNumThreads(0);
+}
@@ -16,8 +16,10 @@
 #include <assert.h>
 #include <gtest/gtest.h>
 #include <iostream>
+#include <random>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #ifdef DEBUG_PIM
 #define NUM_ITER (100)
@@ -159,6 +161,55 @@ int pim_elt_add_profile(bool block, int len) {
   return ret;
 }
 
+int pim_elt_add_bit_exact(uint32_t length) {
+  int ret = 0;
+
+  /* __PIM_API__ call : Initialize PimRuntime */
+  PimInitialize(RT_TYPE_HIP, PIM_FP16);
+
+  PimBo *pim_input0 = PimCreateBo(length, 1, 1, 1, PIM_FP16, MEM_TYPE_PIM);
+  PimBo *pim_input1 = PimCreateBo(length, 1, 1, 1, PIM_FP16, MEM_TYPE_PIM);
+  PimBo *device_output = PimCreateBo(length, 1, 1, 1, PIM_FP16, MEM_TYPE_PIM);
+
+  // Random bit patterns, including infinities, NaNs and denormals.
+  std::mt19937 mt(length);
+  uint16_t *in0 = static_cast<uint16_t *>(pim_input0->data);
+  uint16_t *in1 = static_cast<uint16_t *>(pim_input1->data);
+  for (uint32_t i = 0; i < length; i++) {
+    in0[i] = static_cast<uint16_t>(mt());
+    in1[i] = static_cast<uint16_t>(mt());
+  }
+  half *half0 = static_cast<half *>(pim_input0->data);
+  half *half1 = static_cast<half *>(pim_input1->data);
+  half *out = static_cast<half *>(device_output->data);
+
+  /* __PIM_API__ call : Execute PIM kernel (ELT_ADD) */
+  PimExecuteAdd(device_output, pim_input0, pim_input1, nullptr, true);
+  for (uint32_t i = 0; i < length; i++) {
+    half golden = half0[i] + half1[i];
+    if (memcmp(&golden, &out[i], sizeof(half)) != 0)
+      ret = 1;
+  }
+
+  half scalar = half1[0];
+  PimExecuteAdd(device_output, &scalar, pim_input0, nullptr, true);
+  for (uint32_t i = 0; i < length; i++) {
+    half golden = half0[i] + scalar;
+    if (memcmp(&golden, &out[i], sizeof(half)) != 0)
+      ret = 1;
+  }
+
+  /* __PIM_API__ call : Free memory */
+  PimDestroyBo(pim_input0);
+  PimDestroyBo(pim_input1);
+  PimDestroyBo(device_output);
+
+  /* __PIM_API__ call : Deinitialize PimRuntime */
+  PimDeinitialize();
+
+  return ret;
+}
+
 TEST(HIPIntegrationTest, PimEltAdd1Sync) {
   EXPECT_TRUE(pim_elt_add_up_to_512KB(true, 1 * 1024) == 0);
 }
@@ -189,6 +240,9 @@ TEST(HIPIntegrationTest, PimEltAddProfile1Sync) {
 TEST(HIPIntegrationTest, PimEltAddProfile1Async) {
   EXPECT_TRUE(pim_elt_add_profile(false, (128 * 1024)) == 0);
 }
+TEST(UnitTest, PimEltAddBitExact) {
+  EXPECT_TRUE(pim_elt_add_bit_exact(128 * 1024 + 37) == 0);
+}
 
 // The following tests are commented in Samsung's PIMLibrary, so we keep them
 // disabled here.
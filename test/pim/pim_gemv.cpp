@@ -16,8 +16,12 @@
 #include <assert.h>
 #include <gtest/gtest.h>
 #include <iostream>
+#include <math.h>
+#include <random>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <vector>
 
 #define IN_LENGTH (256)
 #define OUT_LENGTH (4096)
@@ -923,6 +927,239 @@ int pim_gemv_no_accum_desc(bool block) {
   return ret;
 }
 
+enum GemvVariant { GEMV, GEMV_ADD, GEMV_BIAS_RELU, GEMV_TRANSPOSED };
+
+// Compares a GEMV variant against a double precision reference, on a shape
+// that is not a multiple of the kernel's row and K tiles. The result must be
+// the correctly rounded reference up to the FP32 accumulation error.
+int pim_gemv_accuracy(uint32_t in_length, uint32_t out_length,
+                      uint32_t batch_dim, GemvVariant variant) {
+  int ret = 0;
+
+  PimInitialize(RT_TYPE_HIP, PIM_FP16);
+
+  PimBo *input =
+      PimCreateBo(in_length, 1, 1, batch_dim, PIM_FP16, MEM_TYPE_DEVICE);
+  // Transposed weights are stored column-major, i.e., as in_length rows of
+  // out_length elements. The rows of buffers created from a descriptor are
+  // padded to the pitch of bshape_r.
+  PimDesc *weight_desc =
+      PimCreateDesc(batch_dim, 1, out_length, in_length, PIM_FP16, OP_GEMV);
+  PimBo *weight = PimCreateBo(
+      weight_desc, MEM_TYPE_DEVICE,
+      (variant == GEMV_TRANSPOSED) ? GEMV_WEIGHT_T : GEMV_WEIGHT);
+  PimBo *output =
+      PimCreateBo(out_length, 1, 1, batch_dim, PIM_FP16, MEM_TYPE_DEVICE);
+  PimBo *bias =
+      PimCreateBo(out_length, 1, 1, batch_dim, PIM_FP16, MEM_TYPE_DEVICE);
+
+  std::mt19937 mt(123);
+  std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+  half *in = (half *)input->data;
+  half *w = (half *)weight->data;
+  half *out = (half *)output->data;
+  uint32_t pitch = (variant == GEMV_TRANSPOSED) ? weight->bshape_r.h
+                                                : weight->bshape_r.w;
+  for (uint32_t i = 0; i < in_length * batch_dim; i++)
+    in[i] = half(dist(mt));
+  for (uint32_t i = 0; i < in_length * out_length; i++) {
+    uint32_t row = (variant == GEMV_TRANSPOSED) ? out_length : in_length;
+    w[i / row * pitch + i % row] = half(dist(mt));
+  }
+  std::vector<double> initial(out_length * batch_dim, 0.0);
+  half *addend = (variant == GEMV_ADD) ? out : (half *)bias->data;
+  if (variant == GEMV_ADD || variant == GEMV_BIAS_RELU) {
+    for (uint32_t i = 0; i < out_length * batch_dim; i++) {
+      addend[i] = half(dist(mt) * 16.0f);
+      initial[i] = addend[i];
+    }
+  }
+
+  if (variant == GEMV || variant == GEMV_TRANSPOSED)
+    PimExecuteGemv(output, input, weight, nullptr, true);
+  else if (variant == GEMV_ADD) {
+    // Non-blocking by default.
+    PimExecuteGemvAdd(output, input, weight);
+    PimSynchronize();
+  } else
+    PimExecuteGemvAdd(output, input, weight, bias, true, nullptr, true);
+
+  for (uint32_t n = 0; n < batch_dim; n++) {
+    for (uint32_t m = 0; m < out_length; m++) {
+      double sum = initial[n * out_length + m], abs_sum = fabs(sum);
+      for (uint32_t k = 0; k < in_length; k++) {
+        uint32_t index = (variant == GEMV_TRANSPOSED) ? k * pitch + m
+                                                      : m * pitch + k;
+        double prod = (double)w[index] * in[n * in_length + k];
+        sum += prod;
+        abs_sum += fabs(prod);
+      }
+      if (variant == GEMV_BIAS_RELU && sum < 0.0)
+        sum = 0.0;
+      double result = out[n * out_length + m];
+      double tolerance = fabs(sum) / 1024.0 + abs_sum * 1e-6;
+      if (fabs(result - sum) > tolerance) {
+        printf("mismatch at %u, %u: %f != %f\n", n, m, result, sum);
+        ret = -1;
+      }
+    }
+  }
+
+  PimDestroyBo(input);
+  PimDestroyBo(weight);
+  PimDestroyBo(output);
+  PimDestroyBo(bias);
+  PimDestroyDesc(weight_desc);
+
+  PimDeinitialize();
+
+  return ret;
+}
+
+// Runs a GEMV list with 'list_size' entries and compares every entry to a
+// separate GEMV on the same data.
+int pim_gemv_list(uint32_t in_length, uint32_t out_length, uint32_t list_size,
+                  uint32_t batch_dim) {
+  int ret = 0;
+
+  PimInitialize(RT_TYPE_HIP, PIM_FP16);
+
+  PimBo *input = PimCreateBo(in_length, 1, list_size, batch_dim, PIM_FP16,
+                             MEM_TYPE_DEVICE);
+  PimBo *weight = PimCreateBo(in_length, out_length, list_size, 1, PIM_FP16,
+                              MEM_TYPE_DEVICE);
+  PimBo *output = PimCreateBo(out_length, 1, list_size, batch_dim, PIM_FP16,
+                              MEM_TYPE_DEVICE);
+  PimBo *entry_input =
+      PimCreateBo(in_length, 1, 1, batch_dim, PIM_FP16, MEM_TYPE_DEVICE);
+  PimBo *entry_weight =
+      PimCreateBo(in_length, out_length, 1, 1, PIM_FP16, MEM_TYPE_DEVICE);
+  PimBo *entry_output =
+      PimCreateBo(out_length, 1, 1, batch_dim, PIM_FP16, MEM_TYPE_DEVICE);
+
+  std::mt19937 mt(321);
+  std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+  half *in = (half *)input->data;
+  half *w = (half *)weight->data;
+  half *out = (half *)output->data;
+  for (uint32_t i = 0; i < in_length * list_size * batch_dim; i++)
+    in[i] = half(dist(mt));
+  for (uint32_t i = 0; i < in_length * out_length * list_size; i++)
+    w[i] = half(dist(mt));
+
+  ret |= PimExecuteGemvList(output, input, weight, nullptr, true);
+
+  for (uint32_t c = 0; c < list_size; c++) {
+    for (uint32_t n = 0; n < batch_dim; n++)
+      memcpy((half *)entry_input->data + n * in_length,
+             in + (n * list_size + c) * in_length, in_length * sizeof(half));
+    memcpy(entry_weight->data, w + c * out_length * in_length,
+           entry_weight->size);
+    ret |= PimExecuteGemv(entry_output, entry_input, entry_weight, nullptr,
+                          true);
+    for (uint32_t n = 0; n < batch_dim; n++) {
+      if (memcmp((half *)entry_output->data + n * out_length,
+                 out + (n * list_size + c) * out_length,
+                 out_length * sizeof(half))) {
+        printf("mismatch in list entry %u, batch %u\n", c, n);
+        ret = -1;
+      }
+    }
+  }
+
+  PimDestroyBo(input);
+  PimDestroyBo(weight);
+  PimDestroyBo(output);
+  PimDestroyBo(entry_input);
+  PimDestroyBo(entry_weight);
+  PimDestroyBo(entry_output);
+
+  PimDeinitialize();
+
+  return ret;
+}
+
+// Compares GEMV with weights converted by PimConvertGemvWeight, from
+// row-major and from transposed weights, bitwise against GEMV with the
+// original weights.
+int pim_gemv_converted(uint32_t in_length, uint32_t out_length,
+                       uint32_t list_size, uint32_t batch_dim) {
+  int ret = 0;
+
+  PimInitialize(RT_TYPE_HIP, PIM_FP16);
+
+  PimBo *input = PimCreateBo(in_length, 1, list_size, batch_dim, PIM_FP16,
+                             MEM_TYPE_DEVICE);
+  PimBo *weight = PimCreateBo(in_length, out_length, list_size, 1, PIM_FP16,
+                              MEM_TYPE_DEVICE);
+  PimBo *output = PimCreateBo(out_length, 1, list_size, batch_dim, PIM_FP16,
+                              MEM_TYPE_DEVICE);
+  PimBo *converted_output = PimCreateBo(out_length, 1, list_size, batch_dim,
+                                        PIM_FP16, MEM_TYPE_DEVICE);
+
+  std::mt19937 mt(654);
+  std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+  for (uint32_t i = 0; i < in_length * list_size * batch_dim; i++)
+    ((half *)input->data)[i] = half(dist(mt));
+  for (uint32_t i = 0; i < in_length * out_length * list_size; i++)
+    ((half *)weight->data)[i] = half(dist(mt));
+
+  PimDesc *desc = PimCreateDesc(batch_dim, list_size, out_length, in_length,
+                                PIM_FP16, OP_GEMV);
+  PimBo *transposed_weight = PimCreateBo(desc, MEM_TYPE_DEVICE, GEMV_WEIGHT_T);
+  half *w = (half *)weight->data;
+  half *w_t = (half *)transposed_weight->data;
+  uint32_t pitch = transposed_weight->bshape_r.h;
+  for (uint32_t c = 0; c < list_size; c++)
+    for (uint32_t m = 0; m < out_length; m++)
+      for (uint32_t k = 0; k < in_length; k++)
+        w_t[(c * in_length + k) * pitch + m] =
+            w[(c * out_length + m) * in_length + k];
+
+  PimBo *converted_weight = PimConvertGemvWeight(weight);
+  PimBo *converted_transposed = PimConvertGemvWeight(transposed_weight);
+  if (!converted_weight || !converted_transposed) {
+    printf("weight conversion failed\n");
+    ret = -1;
+  } else {
+    // Converted weights can only be used for GEMV.
+    if (PimExecuteAdd(output, converted_weight, converted_weight) == 0 ||
+        PimCopyMemory(weight, converted_weight, DEVICE_TO_DEVICE) == 0) {
+      printf("converted weights used as plain buffer\n");
+      ret = -1;
+    }
+
+    ret |= PimExecuteGemvList(output, input, weight, nullptr, true);
+    ret |= PimExecuteGemvList(converted_output, input, converted_weight,
+                              nullptr, true);
+    if (memcmp(output->data, converted_output->data, output->size)) {
+      printf("mismatch between original and converted weights\n");
+      ret = -1;
+    }
+    ret |= PimExecuteGemvList(converted_output, input, converted_transposed,
+                              nullptr, true);
+    if (memcmp(output->data, converted_output->data, output->size)) {
+      printf("mismatch between original and converted transposed weights\n");
+      ret = -1;
+    }
+  }
+
+  PimDestroyBo(input);
+  PimDestroyBo(weight);
+  if (converted_weight)
+    PimDestroyBo(converted_weight);
+  PimDestroyBo(transposed_weight);
+  if (converted_transposed)
+    PimDestroyBo(converted_transposed);
+  PimDestroyBo(output);
+  PimDestroyBo(converted_output);
+  PimDestroyDesc(desc);
+
+  PimDeinitialize();
+
+  return ret;
+}
+
 TEST(HIPIntegrationTest, PimGemvBatchSync) {
   EXPECT_TRUE(pim_gemv_batch(true) == 0);
 }
@@ -973,3 +1210,27 @@ TEST(HIPIntegrationTest, PimGemvNoAccum512Sync) {
 TEST(HIPIntegrationTest, PimGemvNoAccum256Sync) {
   EXPECT_TRUE(pim_gemv_no_accum_256(true) == 0);
 }
+
+TEST(UnitTest, PimGemvAccuracy) {
+  EXPECT_TRUE(pim_gemv_accuracy(2048 + 77, 131, 3, GEMV) == 0);
+}
+
+TEST(UnitTest, PimGemvAddAccuracy) {
+  EXPECT_TRUE(pim_gemv_accuracy(2048 + 77, 131, 3, GEMV_ADD) == 0);
+}
+
+TEST(UnitTest, PimGemvBiasReluAccuracy) {
+  EXPECT_TRUE(pim_gemv_accuracy(2048 + 77, 131, 3, GEMV_BIAS_RELU) == 0);
+}
+
+TEST(UnitTest, PimGemvTransposedAccuracy) {
+  EXPECT_TRUE(pim_gemv_accuracy(2048 + 77, 131, 3, GEMV_TRANSPOSED) == 0);
+}
+
+TEST(UnitTest, PimGemvList) {
+  EXPECT_TRUE(pim_gemv_list(1000, 300, 5, 2) == 0);
+}
+
+TEST(UnitTest, PimGemvConvertedWeight) {
+  EXPECT_TRUE(pim_gemv_converted(2048 + 77, 131, 3, 2) == 0);
+}
@@ -0,0 +1,150 @@
+/*
+ * Copyright (C) 2021 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system, or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#include "half.hpp"
+#include "pim_mock_api.h"
+#include "pim_runtime_api.h"
+#include <gtest/gtest.h>
+#include <random>
+#include <string.h>
+#include <vector>
+
+#define IN_LENGTH (256)
+#define OUT_LENGTH (64 * 1024)
+#define BATCH_DIM (2)
+
+using half_float::half;
+
+using namespace pim::mock;
+
+static void fill_random(PimBo *bo, uint32_t seed) {
+  std::mt19937 mt(seed);
+  std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+  half *data = static_cast<half *>(bo->data);
+  for (size_t i = 0; i < bo->size / sizeof(half); i++)
+    data[i] = half(dist(mt));
+}
+
+// One step of a decoder: upload of the input, GEMV, scaling, bias and ReLU,
+// followed by a residual addition.
+struct Step {
+  PimBo *host_input, *input, *weight, *output, *bias, *residual;
+
+  Step() {
+    host_input =
+        PimCreateBo(IN_LENGTH, 1, 1, BATCH_DIM, PIM_FP16, MEM_TYPE_HOST);
+    input = PimCreateBo(IN_LENGTH, 1, 1, BATCH_DIM, PIM_FP16, MEM_TYPE_DEVICE);
+    weight =
+        PimCreateBo(IN_LENGTH, OUT_LENGTH, 1, 1, PIM_FP16, MEM_TYPE_DEVICE);
+    output =
+        PimCreateBo(OUT_LENGTH, 1, 1, BATCH_DIM, PIM_FP16, MEM_TYPE_DEVICE);
+    bias = PimCreateBo(OUT_LENGTH, 1, 1, BATCH_DIM, PIM_FP16, MEM_TYPE_DEVICE);
+    residual =
+        PimCreateBo(OUT_LENGTH, 1, 1, BATCH_DIM, PIM_FP16, MEM_TYPE_DEVICE);
+    fill_random(weight, 1);
+    fill_random(bias, 2);
+    fill_random(residual, 3);
+  }
+
+  ~Step() {
+    for (PimBo *bo : {host_input, input, weight, output, bias, residual})
+      PimDestroyBo(bo);
+  }
+
+  void issue(void *stream) {
+    half scale(0.5f);
+    PimCopyMemoryAsync(input, host_input, HOST_TO_DEVICE, stream);
+    PimExecuteGemv(output, input, weight, stream);
+    PimExecuteMul(output, &scale, output, stream);
+    PimExecuteAdd(output, output, bias, stream);
+    PimExecuteRelu(output, output, stream);
+    PimExecuteAdd(residual, residual, output, stream);
+  }
+
+  std::vector<char> result() {
+    PimSynchronize();
+    char *data = static_cast<char *>(residual->data);
+    return std::vector<char>(data, data + residual->size);
+  }
+};
+
+// Replays of a captured graph give the same results as issuing the
+// operations, with the scaling, bias and ReLU fused into one node.
+TEST(UnitTest, PimGraphReplay) {
+  PimInitialize(RT_TYPE_HIP, PIM_FP16);
+  int stream = 0;
+
+  Step eager, captured;
+  ASSERT_EQ(PimBeginCapture(&stream), 0);
+  EXPECT_NE(PimBeginCapture(&stream), 0);
+  // Graphs cannot hold dependencies on other streams.
+  int other = 0;
+  PimEvent *event = PimCreateEvent();
+  EXPECT_NE(PimRecordEvent(event, &stream), 0);
+  EXPECT_NE(PimStreamWaitEvent(&stream, event), 0);
+  EXPECT_EQ(PimRecordEvent(event, &other), 0);
+  PimDestroyEvent(event);
+  captured.issue(&stream);
+  PimGraph *graph = PimEndCapture(&stream);
+  ASSERT_NE(graph, nullptr);
+  EXPECT_EQ(PimEndCapture(&stream), nullptr);
+  // Copy, GEMV, the fused element-wise operations, and the residual
+  // addition, which reads 'output' at the same offsets and is fused as well.
+  EXPECT_EQ(PimGetGraphNumNodes(graph), 3u);
+  // Nothing was executed while capturing.
+  EXPECT_TRUE(captured.result() == eager.result());
+
+  for (uint32_t token = 0; token < 3; token++) {
+    fill_random(eager.host_input, 10 + token);
+    fill_random(captured.host_input, 10 + token);
+    eager.issue(nullptr);
+    EXPECT_EQ(PimLaunchGraph(graph, &stream), 0);
+    PimSynchronize(&stream);
+    EXPECT_TRUE(captured.result() == eager.result()) << "token " << token;
+  }
+
+  PimDestroyGraph(graph);
+  PimDeinitialize();
+}
+
+// Element-wise operations on overlapping, different buffers are not fused.
+TEST(UnitTest, PimGraphNoFusionOfOverlaps) {
+  PimInitialize(RT_TYPE_HIP, PIM_FP16);
+  const uint32_t length = OUT_LENGTH, shift = 64;
+
+  std::vector<half> memory(length + shift);
+  PimBo *head = PimCreateBo(length, 1, 1, 1, PIM_FP16, MEM_TYPE_HOST,
+                            memory.data());
+  PimBo *tail = PimCreateBo(length, 1, 1, 1, PIM_FP16, MEM_TYPE_HOST,
+                            memory.data() + shift);
+  PimBo *ones = PimCreateBo(length, 1, 1, 1, PIM_FP16, MEM_TYPE_HOST);
+  for (uint32_t i = 0; i < length; i++)
+    static_cast<half *>(ones->data)[i] = half(1.0f);
+
+  PimBeginCapture();
+  PimExecuteAdd(head, ones, ones);
+  PimExecuteAdd(tail, tail, ones);
+  PimGraph *graph = PimEndCapture();
+  EXPECT_EQ(PimGetGraphNumNodes(graph), 2u);
+  PimLaunchGraph(graph, nullptr, true);
+  // The second addition sees all results of the first one.
+  bool ok = true;
+  for (uint32_t i = 0; i < length + shift; i++) {
+    float expected = (i < shift) ? 2.0f : (i < length) ? 3.0f : 1.0f;
+    ok = ok && memory[i] == half(expected);
+  }
+  EXPECT_TRUE(ok);
+
+  PimDestroyGraph(graph);
+  for (PimBo *bo : {head, tail, ones})
+    PimDestroyBo(bo);
+  PimDeinitialize();
+}
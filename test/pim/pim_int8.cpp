@@ -0,0 +1,177 @@
+/*
+ * Copyright (C) 2021 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system, or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#include "pim_runtime_api.h"
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <random>
+#include <stdint.h>
+#include <stdio.h>
+
+// Odd sizes, to cover the tails of the vector kernels.
+#define ELT_LENGTH (64 * 1024 + 37)
+#define IN_LENGTH (1000)
+#define OUT_LENGTH (77)
+#define BATCH_DIM (3)
+
+using namespace pim::mock;
+
+static int8_t saturate(int64_t value) {
+  return (int8_t)std::min<int64_t>(std::max<int64_t>(value, -128), 127);
+}
+
+static void fill_random(PimBo *bo, uint32_t seed) {
+  std::mt19937 mt(seed);
+  int8_t *data = (int8_t *)bo->data;
+  for (size_t i = 0; i < bo->size; i++)
+    data[i] = (int8_t)mt();
+}
+
+int pim_int8_elt() {
+  int ret = 0;
+
+  PimInitialize(RT_TYPE_HIP, PIM_INT8);
+
+  PimBo *input0 = PimCreateBo(ELT_LENGTH, 1, 1, 1, PIM_INT8, MEM_TYPE_PIM);
+  PimBo *input1 = PimCreateBo(ELT_LENGTH, 1, 1, 1, PIM_INT8, MEM_TYPE_PIM);
+  PimBo *add = PimCreateBo(ELT_LENGTH, 1, 1, 1, PIM_INT8, MEM_TYPE_PIM);
+  PimBo *mul = PimCreateBo(ELT_LENGTH, 1, 1, 1, PIM_INT8, MEM_TYPE_PIM);
+  PimBo *add_scalar = PimCreateBo(ELT_LENGTH, 1, 1, 1, PIM_INT8, MEM_TYPE_PIM);
+  PimBo *mul_scalar = PimCreateBo(ELT_LENGTH, 1, 1, 1, PIM_INT8, MEM_TYPE_PIM);
+  PimBo *relu = PimCreateBo(ELT_LENGTH, 1, 1, 1, PIM_INT8, MEM_TYPE_PIM);
+  fill_random(input0, 1);
+  fill_random(input1, 2);
+  int8_t scalar = -7;
+
+  ret |= PimExecuteAdd(add, input0, input1, nullptr, true);
+  ret |= PimExecuteMul(mul, input0, input1, nullptr, true);
+  ret |= PimExecuteAdd(add_scalar, &scalar, input0, nullptr, true);
+  ret |= PimExecuteMul(mul_scalar, &scalar, input0, nullptr, true);
+  ret |= PimExecuteRelu(relu, input0, nullptr, true);
+
+  int8_t *in0 = (int8_t *)input0->data;
+  int8_t *in1 = (int8_t *)input1->data;
+  for (size_t i = 0; i < ELT_LENGTH; i++) {
+    if (((int8_t *)add->data)[i] != saturate(in0[i] + in1[i]) ||
+        ((int8_t *)mul->data)[i] != saturate(in0[i] * in1[i]) ||
+        ((int8_t *)add_scalar->data)[i] != saturate(in0[i] + scalar) ||
+        ((int8_t *)mul_scalar->data)[i] != saturate(in0[i] * scalar) ||
+        ((int8_t *)relu->data)[i] != std::max<int8_t>(in0[i], 0)) {
+      printf("mismatch at %zu\n", i);
+      ret = -1;
+      break;
+    }
+  }
+
+  for (PimBo *bo : {input0, input1, add, mul, add_scalar, mul_scalar, relu})
+    PimDestroyBo(bo);
+
+  PimDeinitialize();
+
+  return ret;
+}
+
+int pim_int8_gemv(bool bias_relu) {
+  int ret = 0;
+
+  PimInitialize(RT_TYPE_HIP, PIM_INT8);
+
+  PimBo *input =
+      PimCreateBo(IN_LENGTH, 1, 1, BATCH_DIM, PIM_INT8, MEM_TYPE_DEVICE);
+  PimBo *weight =
+      PimCreateBo(IN_LENGTH, OUT_LENGTH, 1, 1, PIM_INT8, MEM_TYPE_DEVICE);
+  PimBo *bias =
+      PimCreateBo(OUT_LENGTH, 1, 1, BATCH_DIM, PIM_INT8, MEM_TYPE_DEVICE);
+  PimBo *output =
+      PimCreateBo(OUT_LENGTH, 1, 1, BATCH_DIM, PIM_INT8, MEM_TYPE_DEVICE);
+  fill_random(input, 3);
+  fill_random(weight, 4);
+  fill_random(bias, 5);
+  // Small inputs for the first vector, so that not all results saturate.
+  int8_t *in = (int8_t *)input->data;
+  for (size_t i = 0; i < IN_LENGTH; i++)
+    in[i] = in[i] % 2;
+
+  if (bias_relu)
+    ret |= PimExecuteGemvAdd(output, input, weight, bias, true, nullptr, true);
+  else
+    ret |= PimExecuteGemv(output, input, weight, nullptr, true);
+
+  int8_t *w = (int8_t *)weight->data;
+  int8_t *b = (int8_t *)bias->data;
+  int8_t *out = (int8_t *)output->data;
+  for (size_t n = 0; n < BATCH_DIM; n++) {
+    for (size_t m = 0; m < OUT_LENGTH; m++) {
+      int64_t sum = bias_relu ? b[n * OUT_LENGTH + m] : 0;
+      for (size_t k = 0; k < IN_LENGTH; k++)
+        sum += w[m * IN_LENGTH + k] * in[n * IN_LENGTH + k];
+      if (bias_relu)
+        sum = std::max<int64_t>(sum, 0);
+      if (out[n * OUT_LENGTH + m] != saturate(sum)) {
+        printf("mismatch at %zu, %zu: %d != %d\n", n, m,
+               out[n * OUT_LENGTH + m], saturate(sum));
+        ret = -1;
+      }
+    }
+  }
+
+  // Weights converted for GEMV give identical results.
+  PimBo *converted_weight = PimConvertGemvWeight(weight);
+  PimBo *converted_output =
+      PimCreateBo(OUT_LENGTH, 1, 1, BATCH_DIM, PIM_INT8, MEM_TYPE_DEVICE);
+  if (bias_relu)
+    ret |= PimExecuteGemvAdd(converted_output, input, converted_weight, bias,
+                             true, nullptr, true);
+  else
+    ret |= PimExecuteGemv(converted_output, input, converted_weight, nullptr,
+                          true);
+  for (size_t i = 0; i < OUT_LENGTH * BATCH_DIM; i++) {
+    if (((int8_t *)converted_output->data)[i] != out[i]) {
+      printf("mismatch with converted weights at %zu\n", i);
+      ret = -1;
+      break;
+    }
+  }
+
+  // So do transposed weights, as INT8 arithmetic is exact.
+  PimBo *transposed_weight =
+      PimCreateBo(IN_LENGTH, OUT_LENGTH, 1, 1, PIM_INT8, MEM_TYPE_DEVICE);
+  transposed_weight->bshape.t = true;
+  for (size_t m = 0; m < OUT_LENGTH; m++)
+    for (size_t k = 0; k < IN_LENGTH; k++)
+      ((int8_t *)transposed_weight->data)[k * OUT_LENGTH + m] =
+          w[m * IN_LENGTH + k];
+  if (bias_relu)
+    ret |= PimExecuteGemvAdd(converted_output, input, transposed_weight, bias,
+                             true, nullptr, true);
+  else
+    ret |= PimExecuteGemv(converted_output, input, transposed_weight, nullptr,
+                          true);
+  for (size_t i = 0; i < OUT_LENGTH * BATCH_DIM; i++) {
+    if (((int8_t *)converted_output->data)[i] != out[i]) {
+      printf("mismatch with transposed weights at %zu\n", i);
+      ret = -1;
+      break;
+    }
+  }
+
+  for (PimBo *bo : {input, weight, bias, output, converted_weight,
+                    converted_output, transposed_weight})
+    PimDestroyBo(bo);
+
+  PimDeinitialize();
+
+  return ret;
+}
+
+TEST(UnitTest, PimInt8EltSaturating) { EXPECT_TRUE(pim_int8_elt() == 0); }
+TEST(UnitTest, PimInt8Gemv) { EXPECT_TRUE(pim_int8_gemv(false) == 0); }
+TEST(UnitTest, PimInt8GemvBiasRelu) { EXPECT_TRUE(pim_int8_gemv(true) == 0); }
@@ -0,0 +1,142 @@
+/*
+ * Copyright (C) 2021 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system, or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#include "half.hpp"
+#include "pim_mock_api.h"
+#include "pim_runtime_api.h"
+#include <gtest/gtest.h>
+#include <random>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+// Odd sizes, to cover the tails of the vector kernels.
+#define ELT_LENGTH (64 * 1024 + 37)
+#define IN_LENGTH (1000)
+#define OUT_LENGTH (77)
+#define BATCH_DIM (3)
+
+using half_float::half;
+
+using namespace pim::mock;
+
+// Random bits, so that the FP16 data also contains infinities, NaNs and
+// subnormals.
+static void fill_random(PimBo *bo, uint32_t seed) {
+  std::mt19937 mt(seed);
+  char *data = static_cast<char *>(bo->data);
+  for (size_t i = 0; i < bo->size; i++)
+    data[i] = (char)mt();
+}
+
+static void fill_uniform(PimBo *bo, uint32_t seed) {
+  std::mt19937 mt(seed);
+  std::uniform_real_distribution<float> dist(0.0f, 2.0f);
+  half *data = static_cast<half *>(bo->data);
+  for (size_t i = 0; i < bo->size / sizeof(half); i++)
+    data[i] = half(dist(mt));
+}
+
+// Runs all operations with bit-identical results across ISAs with the kernels
+// selected by PIMMOCK_ISA=isa, stores the name of the selected ISA in
+// 'selected' and returns the concatenated results.
+static std::vector<char> run_ops(const char *isa, std::string *selected) {
+  setenv("PIMMOCK_ISA", isa, 1);
+  PimInitialize(RT_TYPE_HIP, PIM_FP16);
+  unsetenv("PIMMOCK_ISA");
+  *selected = PimGetKernelIsa();
+
+  std::vector<PimBo *> outputs;
+  auto output_like = [&](PimBo *bo) {
+    outputs.push_back(PimCreateBo(bo->bshape.w, bo->bshape.h, bo->bshape.c,
+                                  bo->bshape.n, bo->precision, bo->mem_type));
+    return outputs.back();
+  };
+
+  PimBo *input0 = PimCreateBo(ELT_LENGTH, 1, 1, 1, PIM_FP16, MEM_TYPE_PIM);
+  PimBo *input1 = PimCreateBo(ELT_LENGTH, 1, 1, 1, PIM_FP16, MEM_TYPE_PIM);
+  PimBo *bn_input = PimCreateBo(255, 33, 4, 2, PIM_FP16, MEM_TYPE_PIM);
+  PimBo *bn_param = PimCreateBo(1, 1, 4, 1, PIM_FP16, MEM_TYPE_PIM);
+  PimBo *input0_int8 =
+      PimCreateBo(ELT_LENGTH, 1, 1, 1, PIM_INT8, MEM_TYPE_PIM);
+  PimBo *input1_int8 =
+      PimCreateBo(ELT_LENGTH, 1, 1, 1, PIM_INT8, MEM_TYPE_PIM);
+  PimBo *vector_int8 =
+      PimCreateBo(IN_LENGTH, 1, 1, BATCH_DIM, PIM_INT8, MEM_TYPE_DEVICE);
+  PimBo *weight_int8 =
+      PimCreateBo(IN_LENGTH, OUT_LENGTH, 1, 1, PIM_INT8, MEM_TYPE_DEVICE);
+  PimBo *gemv_output_int8 =
+      PimCreateBo(OUT_LENGTH, 1, 1, BATCH_DIM, PIM_INT8, MEM_TYPE_DEVICE);
+  outputs.push_back(gemv_output_int8);
+
+  fill_random(input0, 1);
+  fill_random(input1, 2);
+  fill_random(bn_input, 3);
+  fill_uniform(bn_param, 4);
+  fill_random(input0_int8, 5);
+  fill_random(input1_int8, 6);
+  fill_random(vector_int8, 7);
+  fill_random(weight_int8, 8);
+  half scalar = half(0.75f);
+  int8_t scalar_int8 = -3;
+
+  PimExecuteAdd(output_like(input0), input0, input1, nullptr, true);
+  PimExecuteMul(output_like(input0), input0, input1, nullptr, true);
+  PimExecuteAdd(output_like(input0), &scalar, input0, nullptr, true);
+  PimExecuteMul(output_like(input0), &scalar, input0, nullptr, true);
+  PimExecuteRelu(output_like(input0), input0, nullptr, true);
+  PimExecuteBN(output_like(bn_input), bn_input, bn_param, bn_param, bn_param,
+               bn_param, 1e-5, nullptr, true);
+  PimExecuteAdd(output_like(input0_int8), input0_int8, input1_int8, nullptr,
+                true);
+  PimExecuteMul(output_like(input0_int8), input0_int8, input1_int8, nullptr,
+                true);
+  PimExecuteAdd(output_like(input0_int8), &scalar_int8, input0_int8, nullptr,
+                true);
+  PimExecuteMul(output_like(input0_int8), &scalar_int8, input0_int8, nullptr,
+                true);
+  PimExecuteRelu(output_like(input0_int8), input0_int8, nullptr, true);
+  PimExecuteGemv(gemv_output_int8, vector_int8, weight_int8, nullptr, true);
+
+  std::vector<char> result;
+  for (PimBo *bo : outputs) {
+    char *data = static_cast<char *>(bo->data);
+    result.insert(result.end(), data, data + bo->size);
+    PimDestroyBo(bo);
+  }
+
+  for (PimBo *bo : {input0, input1, bn_input, bn_param, input0_int8,
+                    input1_int8, vector_int8, weight_int8})
+    PimDestroyBo(bo);
+
+  PimDeinitialize();
+
+  return result;
+}
+
+TEST(UnitTest, PimKernelIsaMatchesScalar) {
+  std::string selected;
+  std::vector<char> golden = run_ops("scalar", &selected);
+  EXPECT_EQ(selected, "scalar");
+  for (const char *isa : {"avx2", "avx512", "avx512vnni", "avx512fp16"}) {
+    EXPECT_TRUE(run_ops(isa, &selected) == golden)
+        << isa << " (selected " << selected << ")";
+  }
+}
+
+TEST(UnitTest, PimKernelIsaIgnoresUnknownLevel) {
+  std::string best;
+  std::string selected;
+  run_ops("avx512fp16", &best);
+  run_ops("sse2", &selected);
+  EXPECT_EQ(selected, best);
+}
@@ -10,6 +10,7 @@
  */ 
 
 #include "half.hpp"
+#include "pim_mock_api.h"
 #include "pim_runtime_api.h"
 #include "test_utilities.h"
 #include <algorithm>
@@ -19,6 +20,7 @@
 #include <random>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #define IN_LENGTH 1024
 #define BATCH_DIM 1
@@ -217,6 +219,126 @@ bool test_memcpy_bw_device_pim() {
   return true;
 }
 
+bool pim_pool_reuse(const char *pool_limit) {
+  bool caching = strcmp(pool_limit, "0") != 0;
+  setenv("PIMMOCK_POOL_LIMIT", pool_limit, 1);
+  PimInitialize(RT_TYPE_HIP, PIM_FP16);
+  unsetenv("PIMMOCK_POOL_LIMIT");
+
+  PimMemoryPoolStats before;
+  PimGetMemoryPoolStats(&before);
+  // Multi-megabyte buffers, as created and destroyed per request in a serving
+  // loop. Only the first iteration may allocate new memory.
+  for (int i = 0; i < 100; i++) {
+    PimBo *bo =
+        PimCreateBo(IN_LENGTH * 1024, 1, 1, 3, PIM_FP16, MEM_TYPE_DEVICE);
+    if (!bo)
+      return false;
+    PimDestroyBo(bo);
+  }
+  PimMemoryPoolStats after;
+  PimGetMemoryPoolStats(&after);
+  bool ok = after.num_allocations - before.num_allocations == 100 &&
+            after.num_pool_hits - before.num_pool_hits ==
+                (caching ? 99u : 0u) &&
+            after.bytes_in_use == before.bytes_in_use &&
+            (after.bytes_cached > 0) == caching;
+
+  PimDeinitialize();
+
+  PimGetMemoryPoolStats(&after);
+  return ok && after.bytes_cached == 0;
+}
+
+// Large PIM and device buffers are backed by huge pages if available, either
+// way they start at a huge page boundary.
+bool pim_huge_page_alloc() {
+  const uintptr_t huge_page = 2 * 1024 * 1024;
+  PimInitialize(RT_TYPE_HIP, PIM_FP16);
+
+  bool ok = true;
+  for (PimMemType mem_type : {MEM_TYPE_DEVICE, MEM_TYPE_PIM}) {
+    PimBo *bo = PimCreateBo(IN_LENGTH * 1024 * 3 + 7, 1, 1, 1, PIM_FP16,
+                            mem_type);
+    void *ptr = nullptr;
+    PimAllocMemory(&ptr, 3 * huge_page + 1, mem_type);
+    ok = ok && bo && ptr && (uintptr_t)bo->data % huge_page == 0 &&
+         (uintptr_t)ptr % huge_page == 0;
+    if (bo) {
+      memset(bo->data, 1, bo->size);
+      PimDestroyBo(bo);
+    }
+    PimFreeMemory(ptr, mem_type);
+
+    // Blocks with huge pages are rounded up to huge pages only, not to the
+    // size classes of other blocks first.
+    for (uint32_t pages : {1, 8, 16}) {
+      PimMemoryPoolStats before, after;
+      PimGetMemoryPoolStats(&before);
+      ptr = nullptr;
+      PimAllocMemory(&ptr, pages * huge_page + 1, mem_type);
+      PimGetMemoryPoolStats(&after);
+      ok = ok && ptr &&
+           after.bytes_in_use - before.bytes_in_use == (pages + 1) * huge_page;
+      PimFreeMemory(ptr, mem_type);
+    }
+  }
+
+  PimDeinitialize();
+  return ok;
+}
+
+// The rows of buffers created from a descriptor are padded to the buffer
+// alignment. Operations on and copies between padded and packed buffers give
+// the same elements.
+bool pim_padded_rows() {
+  const uint32_t w = 37, h = 5, c = 3, count = w * h * c;
+  PimInitialize(RT_TYPE_HIP, PIM_FP16);
+
+  PimDesc *desc = PimCreateDesc(1, c, h, w, PIM_FP16, OP_ELT_ADD);
+  PimBo *padded = PimCreateBo(desc, MEM_TYPE_DEVICE);
+  PimBo *padded_output = PimCreateBo(desc, MEM_TYPE_DEVICE);
+  PimBo *packed = PimCreateBo(w, h, c, 1, PIM_FP16, MEM_TYPE_HOST);
+  PimBo *packed_output = PimCreateBo(w, h, c, 1, PIM_FP16, MEM_TYPE_HOST);
+  PimBo *host_output = PimCreateBo(w, h, c, 1, PIM_FP16, MEM_TYPE_HOST);
+  uint32_t pitch = desc->bshape_r.w;
+  bool ok = pitch > w && pitch % 32 == 0 && padded->bshape.w == w &&
+            padded->bshape_r.w == pitch &&
+            padded->size == pitch * h * c * sizeof(half) &&
+            (uintptr_t)padded->data % 64 == 0;
+
+  fill_uniform_random_values<half>(packed->data, count, half(-1.0),
+                                   half(1.0));
+  ok = ok && PimCopyMemory(padded, packed, HOST_TO_DEVICE) == 0;
+  half *in = (half *)packed->data;
+  for (uint32_t row = 0; row < h * c; row++)
+    ok = ok && memcmp((half *)padded->data + row * pitch, in + row * w,
+                      w * sizeof(half)) == 0;
+
+  ok = ok && PimExecuteAdd(packed_output, packed, packed) == 0;
+  // Padded operands only, and padded and packed operands mixed.
+  ok = ok && PimExecuteAdd(padded_output, padded, padded) == 0 &&
+       PimCopyMemory(host_output, padded_output, DEVICE_TO_HOST) == 0 &&
+       memcmp(host_output->data, packed_output->data, packed->size) == 0;
+  ok = ok && PimExecuteAdd(padded_output, padded, packed) == 0 &&
+       PimCopyMemory(host_output, padded_output, DEVICE_TO_HOST) == 0 &&
+       memcmp(host_output->data, packed_output->data, packed->size) == 0;
+  // A packed operand of another shape has the storage of the packed output,
+  // but not its rows, so it cannot be mixed with a padded operand.
+  PimBo *flat = PimCreateBo(count, 1, 1, 1, PIM_FP16, MEM_TYPE_HOST);
+  ok = ok && PimExecuteAdd(packed_output, flat, flat) == 0 &&
+       PimExecuteAdd(packed_output, flat, padded) != 0 &&
+       PimExecuteAdd(packed_output, padded, flat) != 0;
+
+  for (PimBo *bo :
+       {padded, padded_output, packed, packed_output, host_output, flat})
+    PimDestroyBo(bo);
+  PimDestroyDesc(desc);
+
+  PimDeinitialize();
+  return ok;
+}
+
 TEST(UnitTest, PimMemCopyHostAndDeviceTest) {
   EXPECT_TRUE(test_memcpy_bw_host_device());
 }
@@ -230,6 +352,10 @@ TEST(UnitTest, simplePimAllocFree) { EXPECT_TRUE(simple_pim_alloc_free()); }
 TEST(UnitTest, PimRepeatAllocateFree) {
   EXPECT_TRUE(pim_repeat_allocate_free());
 }
+TEST(UnitTest, PimMemoryPoolReuse) { EXPECT_TRUE(pim_pool_reuse("16777216")); }
+TEST(UnitTest, PimMemoryPoolDisabled) { EXPECT_TRUE(pim_pool_reuse("0")); }
+TEST(UnitTest, PimHugePageAlloc) { EXPECT_TRUE(pim_huge_page_alloc()); }
+TEST(UnitTest, PimPaddedRows) { EXPECT_TRUE(pim_padded_rows()); }
 // The following test is unsupported because we do all allocation on the host
 // and will run into std::bad_alloc after depleting the hosts RAM.
 //TEST(UnitTest, PimAllocateExceedBlocksize) {
@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2021 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system, or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#include "pim_mock_api.h"
+#include "pim_runtime_api.h"
+#include <gtest/gtest.h>
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+
+#define LENGTH (64 * 1024)
+#define ROWS 256
+
+using namespace pim::mock;
+
+static PimRooflineStats get_roofline(const char *name) {
+  uint32_t num_stats = 0;
+  PimGetRooflineStats(nullptr, &num_stats);
+  std::vector<PimRooflineStats> stats(num_stats);
+  EXPECT_EQ(PimGetRooflineStats(stats.data(), &num_stats), 0);
+  for (const PimRooflineStats &function : stats)
+    if (strcmp(function.name, name) == 0)
+      return function;
+  ADD_FAILURE() << "No roofline of " << name;
+  return PimRooflineStats{};
+}
+
+// After probing the peaks, blocking and non-blocking operations and copies
+// are counted with their achieved rates, and the intensity follows from their
+// shapes.
+TEST(UnitTest, PimRooflineStats) {
+  PimInitialize(RT_TYPE_HIP, PIM_FP16);
+  PimMachinePeaks peaks;
+  EXPECT_EQ(PimProbeMachinePeaks(&peaks), 0);
+  EXPECT_GT(peaks.bytes_per_sec, 0);
+  EXPECT_GT(peaks.flops_per_sec, 0);
+
+  PimBo *input = PimCreateBo(LENGTH, 1, 1, 1, PIM_FP16, MEM_TYPE_PIM);
+  PimBo *output = PimCreateBo(LENGTH, 1, 1, 1, PIM_FP16, MEM_TYPE_PIM);
+  PimBo *vector = PimCreateBo(LENGTH, 1, 1, 1, PIM_FP16, MEM_TYPE_PIM);
+  PimBo *matrix = PimCreateBo(LENGTH, ROWS, 1, 1, PIM_FP16, MEM_TYPE_PIM);
+  PimBo *result = PimCreateBo(ROWS, 1, 1, 1, PIM_FP16, MEM_TYPE_PIM);
+  EXPECT_EQ(PimResetApiStats(), 0);
+
+  const int num_calls = 3;
+  for (int i = 0; i < num_calls; i++)
+    PimExecuteAdd(output, input, input, nullptr, true);
+  PimExecuteGemv(result, vector, matrix, nullptr, false);
+  int stream;
+  PimCopyMemory(output, input, PIM_TO_PIM);
+  PimCopyMemoryAsync(output, input, PIM_TO_PIM, &stream);
+  PimSynchronize(nullptr);
+
+  PimRooflineStats add = get_roofline("PimExecuteAdd");
+  EXPECT_EQ(add.num_executions, uint64_t{num_calls});
+  EXPECT_GT(add.total_ns, 0u);
+  EXPECT_GT(add.bytes_per_sec, 0);
+  EXPECT_GT(add.roof_fraction, 0);
+  // One FLOP per 2 + 2 + 2 bytes.
+  EXPECT_DOUBLE_EQ(add.intensity, 1.0 / 6);
+
+  PimRooflineStats gemv = get_roofline("PimExecuteGemv");
+  EXPECT_EQ(gemv.num_executions, 1u);
+  EXPECT_GT(gemv.flops_per_sec, 0);
+  EXPECT_DOUBLE_EQ(gemv.intensity,
+                   2.0 * LENGTH * ROWS /
+                       (vector->size + matrix->size + result->size));
+  // Blocking and non-blocking copies, which only move bytes.
+  PimRooflineStats copy = get_roofline("PimCopyMemory");
+  EXPECT_EQ(copy.num_executions, 2u);
+  EXPECT_GT(copy.bytes_per_sec, 0);
+  EXPECT_GT(copy.roof_fraction, 0);
+  EXPECT_EQ(copy.flops_per_sec, 0);
+  EXPECT_EQ(copy.intensity, 0);
+  EXPECT_FALSE(copy.compute_bound);
+
+  EXPECT_EQ(get_roofline("PimExecuteMul").num_executions, 0u);
+  EXPECT_EQ(get_roofline("PimExecuteMul").roof_fraction, 0);
+
+  for (PimBo *bo : {input, output, vector, matrix, result})
+    PimDestroyBo(bo);
+  PimDeinitialize();
+}
@@ -0,0 +1,304 @@
+/*
+ * Copyright (C) 2021 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system, or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#include "half.hpp"
+#include "pim_mock_api.h"
+#include "pim_runtime_api.h"
+#include <gtest/gtest.h>
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+
+#define LENGTH (64 * 1024)
+#define NUM_ITER (100)
+
+using half_float::half;
+
+using namespace pim::mock;
+
+static void fill(PimBo *bo, float value) {
+  half *data = static_cast<half *>(bo->data);
+  for (size_t i = 0; i < bo->size / sizeof(half); i++)
+    data[i] = half(value);
+}
+
+static bool all_equal(PimBo *bo, float value) {
+  const half *data = static_cast<const half *>(bo->data);
+  for (size_t i = 0; i < bo->size / sizeof(half); i++)
+    if (data[i] != half(value))
+      return false;
+  return true;
+}
+
+// Non-blocking operations of a stream run in order, each one depends on the
+// result of the previous one.
+TEST(UnitTest, PimStreamInOrder) {
+  PimInitialize(RT_TYPE_HIP, PIM_FP16);
+  int stream = 0;
+
+  PimBo *input = PimCreateBo(LENGTH, 1, 1, 1, PIM_FP16, MEM_TYPE_PIM);
+  PimBo *output = PimCreateBo(LENGTH, 1, 1, 1, PIM_FP16, MEM_TYPE_PIM);
+  PimBo *host = PimCreateBo(LENGTH, 1, 1, 1, PIM_FP16, MEM_TYPE_HOST);
+  fill(input, 1.0f);
+  fill(output, 0.0f);
+  for (int i = 0; i < NUM_ITER; i++)
+    EXPECT_EQ(PimExecuteAdd(output, output, input, &stream, false), 0);
+  // The scalar is read when the operation is issued.
+  half scalar(2.0f);
+  EXPECT_EQ(PimExecuteMul(output, &scalar, output, &stream, false), 0);
+  scalar = half(0.0f);
+  EXPECT_EQ(PimSynchronize(&stream), 0);
+  EXPECT_TRUE(all_equal(output, 2.0f * NUM_ITER));
+
+  // Blocking operations run after the enqueued ones, and copies wait for
+  // them.
+  for (int i = 0; i < NUM_ITER; i++)
+    PimExecuteAdd(output, output, input, &stream, false);
+  PimExecuteRelu(output, output, &stream, true);
+  EXPECT_TRUE(all_equal(output, 3.0f * NUM_ITER));
+  // Blocking operations of the default stream also run after the operations
+  // of the other streams.
+  for (int i = 0; i < NUM_ITER; i++)
+    PimExecuteAdd(output, output, input, &stream, false);
+  PimExecuteRelu(output, output, nullptr, true);
+  EXPECT_TRUE(all_equal(output, 4.0f * NUM_ITER));
+  for (int i = 0; i < NUM_ITER; i++)
+    PimExecuteAdd(output, output, input, &stream, false);
+  PimCopyMemory(host, output, PIM_TO_HOST);
+  EXPECT_TRUE(all_equal(host, 5.0f * NUM_ITER));
+
+  // Invalid operands are rejected when the operation is issued.
+  PimBo *other = PimCreateBo(LENGTH / 2, 1, 1, 1, PIM_FP16, MEM_TYPE_PIM);
+  EXPECT_NE(PimExecuteAdd(other, output, input, &stream, false), 0);
+
+  for (PimBo *bo : {input, output, host, other})
+    PimDestroyBo(bo);
+  PimDeinitialize();
+}
+
+// Streams run concurrently, PimSynchronize without a stream waits for all
+// streams of the device, and the results match blocking execution.
+TEST(UnitTest, PimStreamsMatchBlocking) {
+  PimSetNumThreads(2);
+  PimInitialize(RT_TYPE_HIP, PIM_FP16);
+  const int num_streams = 3;
+  int streams[num_streams];
+
+  std::vector<PimBo *> inputs, outputs, golden;
+  for (int s = 0; s < num_streams; s++) {
+    inputs.push_back(PimCreateBo(LENGTH, 1, 1, 1, PIM_FP16, MEM_TYPE_PIM));
+    outputs.push_back(PimCreateBo(LENGTH, 1, 1, 1, PIM_FP16, MEM_TYPE_PIM));
+    golden.push_back(PimCreateBo(LENGTH, 1, 1, 1, PIM_FP16, MEM_TYPE_PIM));
+    fill(inputs[s], s + 1.0f);
+    fill(outputs[s], 0.0f);
+    fill(golden[s], 0.0f);
+  }
+  for (int i = 0; i < NUM_ITER; i++) {
+    for (int s = 0; s < num_streams; s++) {
+      PimExecuteAdd(outputs[s], outputs[s], inputs[s], &streams[s], false);
+      PimExecuteAdd(golden[s], golden[s], inputs[s], nullptr, true);
+    }
+  }
+  EXPECT_EQ(PimSynchronize(), 0);
+  for (int s = 0; s < num_streams; s++) {
+    EXPECT_TRUE(all_equal(golden[s], (s + 1.0f) * NUM_ITER));
+    EXPECT_EQ(memcmp(outputs[s]->data, golden[s]->data, outputs[s]->size), 0)
+        << "stream " << s;
+  }
+
+  for (int s = 0; s < num_streams; s++) {
+    PimDestroyBo(inputs[s]);
+    PimDestroyBo(outputs[s]);
+    PimDestroyBo(golden[s]);
+  }
+  PimDeinitialize();
+  PimSetNumThreads(0);
+}
+
+// Events order operations of different streams: the second stream consumes
+// the result of the first one without synchronizing the host.
+TEST(UnitTest, PimStreamEvents) {
+  PimInitialize(RT_TYPE_HIP, PIM_FP16);
+  int producer = 0, consumer = 0;
+
+  PimEvent *event = PimCreateEvent();
+  EXPECT_EQ(PimQueryEvent(event), 0);
+  PimBo *input = PimCreateBo(LENGTH, 1, 1, 1, PIM_FP16, MEM_TYPE_PIM);
+  PimBo *produced = PimCreateBo(LENGTH, 1, 1, 1, PIM_FP16, MEM_TYPE_PIM);
+  PimBo *consumed = PimCreateBo(LENGTH, 1, 1, 1, PIM_FP16, MEM_TYPE_PIM);
+  fill(input, 1.0f);
+  fill(produced, 0.0f);
+  for (int i = 0; i < NUM_ITER; i++)
+    PimExecuteAdd(produced, produced, input, &producer, false);
+  EXPECT_EQ(PimRecordEvent(event, &producer), 0);
+  EXPECT_EQ(PimStreamWaitEvent(&consumer, event), 0);
+  PimExecuteAdd(consumed, produced, produced, &consumer, false);
+  EXPECT_EQ(PimSynchronizeEvent(event), 0);
+  EXPECT_EQ(PimQueryEvent(event), 0);
+  EXPECT_TRUE(all_equal(produced, NUM_ITER));
+  PimSynchronize(&consumer);
+  EXPECT_TRUE(all_equal(consumed, 2.0f * NUM_ITER));
+  EXPECT_NE(PimQueryEvent(nullptr), 0);
+
+  for (PimBo *bo : {input, produced, consumed})
+    PimDestroyBo(bo);
+  PimDestroyEvent(event);
+  PimDeinitialize();
+}
+
+// Destroying a stream waits for its operations. Events recorded on it stay
+// valid, and its handle identifies a new stream afterwards.
+TEST(UnitTest, PimStreamLifetime) {
+  PimInitialize(RT_TYPE_HIP, PIM_FP16);
+  void *stream = PimCreateStream();
+  EXPECT_NE(stream, nullptr);
+  EXPECT_NE(PimCreateStream(), stream);
+
+  PimBo *input = PimCreateBo(LENGTH, 1, 1, 1, PIM_FP16, MEM_TYPE_PIM);
+  PimBo *output = PimCreateBo(LENGTH, 1, 1, 1, PIM_FP16, MEM_TYPE_PIM);
+  PimEvent *event = PimCreateEvent();
+  fill(input, 1.0f);
+  fill(output, 0.0f);
+  for (int i = 0; i < NUM_ITER; i++)
+    PimExecuteAdd(output, output, input, stream, false);
+  PimRecordEvent(event, stream);
+  EXPECT_EQ(PimDestroyStream(stream), 0);
+  EXPECT_TRUE(all_equal(output, NUM_ITER));
+  EXPECT_EQ(PimQueryEvent(event), 0);
+  EXPECT_EQ(PimSynchronizeEvent(event), 0);
+
+  PimExecuteAdd(output, output, input, stream, false);
+  PimSynchronize(stream);
+  EXPECT_TRUE(all_equal(output, NUM_ITER + 1.0f));
+  EXPECT_EQ(PimBeginCapture(stream), 0);
+  EXPECT_NE(PimDestroyStream(stream), 0);
+  PimDestroyGraph(PimEndCapture(stream));
+  EXPECT_EQ(PimDestroyStream(stream), 0);
+  EXPECT_NE(PimDestroyStream(nullptr), 0);
+
+  for (PimBo *bo : {input, output})
+    PimDestroyBo(bo);
+  PimDestroyEvent(event);
+  PimDeinitialize();
+}
+
+// Non-blocking copies run on the copy engine in the order of their stream:
+// the upload of the next input overlaps with the computation on the current
+// one.
+TEST(UnitTest, PimStreamAsyncCopy) {
+  PimInitialize(RT_TYPE_HIP, PIM_FP16);
+  int copy_stream = 0, compute_stream = 0;
+  const int num_batches = 4;
+
+  PimCopyEngineStats before, after;
+  PimGetCopyEngineStats(&before);
+  PimDesc *desc = PimCreateDesc(1, 1, 3, LENGTH / 4 + 5, PIM_FP16);
+  PimBo *host = PimCreateBo(LENGTH / 4 + 5, 3, 1, 1, PIM_FP16, MEM_TYPE_HOST);
+  PimBo *result = PimCreateBo(LENGTH / 4 + 5, 3, 1, 1, PIM_FP16,
+                              MEM_TYPE_HOST);
+  // Double buffering of the padded inputs.
+  PimBo *inputs[2] = {PimCreateBo(desc, MEM_TYPE_PIM),
+                      PimCreateBo(desc, MEM_TYPE_PIM)};
+  PimBo *sum = PimCreateBo(desc, MEM_TYPE_PIM);
+  PimEvent *uploaded[2] = {PimCreateEvent(), PimCreateEvent()};
+  PimEvent *consumed[2] = {PimCreateEvent(), PimCreateEvent()};
+  fill(host, 1.0f);
+  fill(sum, 0.0f);
+
+  for (int i = 0; i < num_batches; i++) {
+    int b = i % 2;
+    PimStreamWaitEvent(&copy_stream, consumed[b]);
+    EXPECT_EQ(PimCopyMemoryAsync(inputs[b], host, HOST_TO_PIM, &copy_stream),
+              0);
+    PimRecordEvent(uploaded[b], &copy_stream);
+    PimStreamWaitEvent(&compute_stream, uploaded[b]);
+    PimExecuteAdd(sum, sum, inputs[b], &compute_stream, false);
+    PimRecordEvent(consumed[b], &compute_stream);
+  }
+  EXPECT_EQ(PimCopyMemoryAsync(result, sum, PIM_TO_HOST, &compute_stream), 0);
+  PimSynchronize(&compute_stream);
+  EXPECT_TRUE(all_equal(result, num_batches));
+
+  PimGetCopyEngineStats(&after);
+  EXPECT_EQ(after.num_copies - before.num_copies, num_batches + 1u);
+  EXPECT_EQ(after.bytes_copied - before.bytes_copied,
+            (num_batches + 1u) * host->size);
+  EXPECT_EQ(after.queue_depth, 0u);
+  EXPECT_EQ(after.bytes_in_flight, 0u);
+  EXPECT_GE(after.max_queue_depth, 1u);
+
+  for (PimBo *bo : {host, result, inputs[0], inputs[1], sum})
+    PimDestroyBo(bo);
+  for (PimEvent *event : {uploaded[0], uploaded[1], consumed[0], consumed[1]})
+    PimDestroyEvent(event);
+  PimDestroyDesc(desc);
+  PimDeinitialize();
+}
+
+// Deferred element-wise operations run before anything consuming their
+// results: copies, operations on other streams waiting for an event, and the
+// synchronization of the host. The results match immediate execution.
+TEST(UnitTest, PimStreamDeferred) {
+  PimInitialize(RT_TYPE_HIP, PIM_FP16);
+  int stream = 0, consumer = 0;
+
+  PimBo *input = PimCreateBo(LENGTH, 1, 1, 1, PIM_FP16, MEM_TYPE_PIM);
+  PimBo *bias = PimCreateBo(LENGTH, 1, 1, 1, PIM_FP16, MEM_TYPE_PIM);
+  PimBo *output = PimCreateBo(LENGTH, 1, 1, 1, PIM_FP16, MEM_TYPE_PIM);
+  PimBo *golden = PimCreateBo(LENGTH, 1, 1, 1, PIM_FP16, MEM_TYPE_PIM);
+  PimBo *host = PimCreateBo(LENGTH, 1, 1, 1, PIM_FP16, MEM_TYPE_HOST);
+  PimBo *sum = PimCreateBo(LENGTH, 1, 1, 1, PIM_FP16, MEM_TYPE_PIM);
+  half *data = static_cast<half *>(input->data);
+  for (size_t i = 0; i < LENGTH; i++)
+    data[i] = half(static_cast<float>(i % 7) - 3.0f);
+  fill(bias, 1.0f);
+  half scalar(2.0f);
+  PimExecuteMul(golden, &scalar, input, nullptr, true);
+  PimExecuteAdd(golden, golden, bias, nullptr, true);
+  PimExecuteRelu(golden, golden, nullptr, true);
+
+  EXPECT_EQ(PimSetDeferredExecution(true), 0);
+  // Consumed by a copy.
+  fill(output, 0.0f);
+  PimExecuteMul(output, &scalar, input, &stream, false);
+  PimExecuteAdd(output, output, bias, &stream, false);
+  PimExecuteRelu(output, output, &stream, false);
+  PimCopyMemoryAsync(host, output, PIM_TO_HOST, &stream);
+  PimSynchronize(&stream);
+  EXPECT_EQ(memcmp(host->data, golden->data, host->size), 0);
+
+  // Consumed by another stream.
+  fill(output, 0.0f);
+  PimEvent *event = PimCreateEvent();
+  PimExecuteMul(output, &scalar, input, &stream, false);
+  PimExecuteAdd(output, output, bias, &stream, false);
+  PimExecuteRelu(output, output, &stream, false);
+  PimRecordEvent(event, &stream);
+  PimStreamWaitEvent(&consumer, event);
+  PimExecuteAdd(sum, output, output, &consumer, false);
+  PimSynchronize(&consumer);
+  PimExecuteAdd(host, golden, golden, nullptr, true);
+  EXPECT_EQ(memcmp(sum->data, host->data, sum->size), 0);
+
+  // Consumed by the host.
+  fill(output, 0.0f);
+  PimExecuteMul(output, &scalar, input, &stream, false);
+  PimExecuteAdd(output, output, bias, &stream, false);
+  PimExecuteRelu(output, output, &stream, false);
+  PimSynchronize();
+  EXPECT_EQ(memcmp(output->data, golden->data, output->size), 0);
+  EXPECT_EQ(PimSetDeferredExecution(false), 0);
+
+  for (PimBo *bo : {input, bias, output, golden, host, sum})
+    PimDestroyBo(bo);
+  PimDestroyEvent(event);
+  PimDeinitialize();
+}
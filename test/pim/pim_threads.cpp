@@ -0,0 +1,145 @@
+/*
+ * Copyright (C) 2021 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system, or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#include "half.hpp"
+#include "pim_mock_api.h"
+#include "pim_runtime_api.h"
+#include <gtest/gtest.h>
+#include <random>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+#define IN_LENGTH (1024)
+#define OUT_LENGTH (4096)
+#define ELT_LENGTH (1024 * 1024)
+#define BATCH_DIM (4)
+
+using half_float::half;
+
+using namespace pim::mock;
+
+static void fill_random(PimBo *bo, uint32_t seed) {
+  std::mt19937 mt(seed);
+  std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+  half *data = static_cast<half *>(bo->data);
+  for (size_t i = 0; i < bo->size / sizeof(half); i++)
+    data[i] = half(dist(mt));
+}
+
+// Runs GEMV, ADD, BN and a copy with the given number of threads on the
+// given device and returns the concatenated results.
+static std::vector<char> run_ops(uint32_t num_threads, uint32_t device = 0) {
+  PimSetNumThreads(num_threads);
+  PimInitialize(RT_TYPE_HIP, PIM_FP16);
+  PimSetDevice(device);
+
+  PimBo *input =
+      PimCreateBo(IN_LENGTH, 1, 1, BATCH_DIM, PIM_FP16, MEM_TYPE_DEVICE);
+  PimBo *weight =
+      PimCreateBo(IN_LENGTH, OUT_LENGTH, 1, 1, PIM_FP16, MEM_TYPE_DEVICE);
+  PimBo *gemv_output =
+      PimCreateBo(OUT_LENGTH, 1, 1, BATCH_DIM, PIM_FP16, MEM_TYPE_DEVICE);
+  PimBo *elt_input = PimCreateBo(ELT_LENGTH, 1, 1, 1, PIM_FP16, MEM_TYPE_PIM);
+  PimBo *elt_output = PimCreateBo(ELT_LENGTH, 1, 1, 1, PIM_FP16, MEM_TYPE_PIM);
+  PimBo *bn_input = PimCreateBo(256, 256, 4, 2, PIM_FP16, MEM_TYPE_PIM);
+  PimBo *bn_output = PimCreateBo(256, 256, 4, 2, PIM_FP16, MEM_TYPE_PIM);
+  PimBo *bn_param = PimCreateBo(1, 1, 4, 1, PIM_FP16, MEM_TYPE_PIM);
+  PimBo *copy_output = PimCreateBo(ELT_LENGTH, 1, 1, 1, PIM_FP16, MEM_TYPE_PIM);
+
+  fill_random(input, 1);
+  fill_random(weight, 2);
+  fill_random(elt_input, 3);
+  fill_random(bn_input, 4);
+  fill_random(bn_param, 5);
+
+  PimExecuteGemv(gemv_output, input, weight, nullptr, true);
+  PimExecuteAdd(elt_output, elt_input, elt_input, nullptr, true);
+  PimExecuteBN(bn_output, bn_input, bn_param, bn_param, bn_param, bn_param,
+               1e-5, nullptr, true);
+  PimCopyMemory(copy_output, elt_output, PIM_TO_PIM);
+
+  std::vector<char> result;
+  for (PimBo *bo : {gemv_output, elt_output, bn_output, copy_output}) {
+    char *data = static_cast<char *>(bo->data);
+    result.insert(result.end(), data, data + bo->size);
+  }
+
+  for (PimBo *bo : {input, weight, gemv_output, elt_input, elt_output,
+                    bn_input, bn_output, bn_param, copy_output})
+    PimDestroyBo(bo);
+
+  PimSetDevice(0);
+  PimDeinitialize();
+  PimSetNumThreads(0);
+
+  return result;
+}
+
+TEST(UnitTest, PimMultiThreadedMatchesSingleThreaded) {
+  std::vector<char> golden = run_ops(1);
+  for (uint32_t num_threads : {2, 3, 8}) {
+    EXPECT_TRUE(run_ops(num_threads) == golden) << num_threads << " threads";
+  }
+}
+
+// Node 0 exists on every host with NUMA support, placing a device on it
+// must not change the results.
+TEST(UnitTest, PimNumaDevicePlacement) {
+  std::vector<char> golden = run_ops(4);
+  setenv("PIMMOCK_DEVICE_NODES", "0", 1);
+  std::vector<char> placed = run_ops(4, 1);
+  int node = PimGetDeviceNumaNode(1);
+  unsetenv("PIMMOCK_DEVICE_NODES");
+  EXPECT_TRUE(node == 0 || node == -1);
+  EXPECT_TRUE(placed == golden);
+}
+
+TEST(UnitTest, PimSetNumThreads) {
+  PimSetNumThreads(3);
+  PimInitialize(RT_TYPE_HIP, PIM_FP16);
+  EXPECT_EQ(PimGetNumThreads(), 3u);
+  PimSetNumThreads(5);
+  EXPECT_EQ(PimGetNumThreads(), 5u);
+  PimDeinitialize();
+  EXPECT_EQ(PimGetNumThreads(), 1u);
+  PimSetNumThreads(0);
+}
+
+// Operations on other host threads keep using the pool they started with
+// while the threads are changed.
+TEST(UnitTest, PimSetNumThreadsConcurrent) {
+  PimSetNumThreads(2);
+  PimInitialize(RT_TYPE_HIP, PIM_FP16);
+  PimBo *input = PimCreateBo(ELT_LENGTH, 1, 1, 1, PIM_FP16, MEM_TYPE_PIM);
+  PimBo *golden = PimCreateBo(ELT_LENGTH, 1, 1, 1, PIM_FP16, MEM_TYPE_PIM);
+  PimBo *output = PimCreateBo(ELT_LENGTH, 1, 1, 1, PIM_FP16, MEM_TYPE_PIM);
+  fill_random(input, 6);
+  PimExecuteAdd(golden, input, input, nullptr, true);
+
+  bool same = true;
+  std::thread worker([&] {
+    for (int i = 0; i < 20; i++) {
+      PimExecuteAdd(output, input, input, nullptr, true);
+      same = same && memcmp(output->data, golden->data, output->size) == 0;
+    }
+  });
+  for (uint32_t i = 0; i < 20; i++)
+    PimSetNumThreads(2 + i % 3);
+  worker.join();
+  EXPECT_TRUE(same);
+
+  for (PimBo *bo : {input, golden, output})
+    PimDestroyBo(bo);
+  PimDeinitialize();
+  PimSetNumThreads(0);
+}
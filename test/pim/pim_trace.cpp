@@ -0,0 +1,112 @@
+/*
+ * Copyright (C) 2021 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system, or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#include "pim_mock_api.h"
+#include "pim_runtime_api.h"
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <unistd.h>
+
+#define LENGTH (64 * 1024)
+
+using namespace pim::mock;
+
+static std::string read_file(const char *path) {
+  std::string contents;
+  FILE *file = fopen(path, "r");
+  if (!file)
+    return contents;
+  char buffer[4096];
+  size_t count;
+  while ((count = fread(buffer, 1, sizeof(buffer), file)) > 0)
+    contents.append(buffer, count);
+  fclose(file);
+  return contents;
+}
+
+static bool contains(const std::string &text, const std::string &pattern) {
+  return text.find(pattern) != std::string::npos;
+}
+
+// API calls are traced on the lane of the host thread with the shape,
+// precision and memory type of their output, and non-blocking operations
+// also on the lane of their stream. The spans are written on demand and
+// when tracing stops.
+TEST(UnitTest, PimTraceSpans) {
+  char path[] = "/tmp/pim_trace_XXXXXX";
+  int fd = mkstemp(path);
+  ASSERT_GE(fd, 0);
+  close(fd);
+  PimSetNumThreads(2);
+  PimInitialize(RT_TYPE_HIP, PIM_FP16);
+  int stream = 0;
+  EXPECT_NE(PimStartTrace("/nonexistent/trace.json"), 0);
+  ASSERT_EQ(PimStartTrace(path), 0);
+
+  PimBo *input = PimCreateBo(LENGTH, 2, 1, 1, PIM_FP16, MEM_TYPE_PIM);
+  PimBo *output = PimCreateBo(LENGTH, 2, 1, 1, PIM_FP16, MEM_TYPE_PIM);
+  PimBo *host = PimCreateBo(LENGTH, 2, 1, 1, PIM_FP16, MEM_TYPE_HOST);
+  PimExecuteAdd(output, input, input, &stream, false);
+  PimSynchronize(&stream);
+  EXPECT_EQ(PimFlushTrace(), 0);
+  std::string trace = read_file(path);
+  EXPECT_EQ(trace.compare(0, 1, "["), 0);
+  EXPECT_TRUE(contains(trace, "\"name\":\"PimExecuteAdd\""));
+  EXPECT_TRUE(contains(trace, "\"shape\":\"(w=65536, h=2, c=1, n=1)\""));
+  EXPECT_TRUE(contains(trace, "\"precision\":\"PIM_FP16\""));
+  EXPECT_TRUE(contains(trace, "\"mem_type\":\"MEM_TYPE_PIM\""));
+  EXPECT_TRUE(contains(trace, "\"args\":{\"name\":\"host thread"));
+  EXPECT_TRUE(contains(trace, "\"args\":{\"name\":\"stream"));
+  EXPECT_TRUE(contains(trace, "\"args\":{\"name\":\"device 0\"}"));
+  EXPECT_FALSE(contains(trace, "PimCopyMemory"));
+
+  PimCopyMemoryAsync(host, output, PIM_TO_HOST, &stream);
+  PimSynchronize(&stream);
+  EXPECT_EQ(PimStopTrace(), 0);
+  trace = read_file(path);
+  EXPECT_TRUE(contains(trace, "\"name\":\"PimCopyMemory\""));
+  EXPECT_TRUE(contains(trace, "\"mem_type\":\"MEM_TYPE_HOST\""));
+  EXPECT_EQ(trace.substr(trace.size() - 3), "\n]\n");
+
+  // Calls after tracing stopped are not traced.
+  PimExecuteRelu(output, input, nullptr, true);
+  EXPECT_FALSE(contains(read_file(path), "PimExecuteRelu"));
+
+  for (PimBo *bo : {input, output, host})
+    PimDestroyBo(bo);
+  PimDeinitialize();
+  PimSetNumThreads(0);
+  remove(path);
+}
+
+// Spans which do not fit into the buffer of their thread are dropped and
+// reported, the trace stays complete.
+TEST(UnitTest, PimTraceDropped) {
+  char path[] = "/tmp/pim_trace_XXXXXX";
+  int fd = mkstemp(path);
+  ASSERT_GE(fd, 0);
+  close(fd);
+  setenv("PIMMOCK_TRACE_EVENTS", "4", 1);
+  setenv("PIMMOCK_TRACE", path, 1);
+  PimInitialize(RT_TYPE_HIP, PIM_FP16);
+  unsetenv("PIMMOCK_TRACE");
+  unsetenv("PIMMOCK_TRACE_EVENTS");
+  for (int i = 0; i < 10; i++)
+    PimExecuteDummy();
+  PimDeinitialize();
+
+  std::string trace = read_file(path);
+  EXPECT_TRUE(contains(trace, "spans dropped"));
+  EXPECT_EQ(trace.substr(trace.size() - 3), "\n]\n");
+  remove(path);
+}